@@ -21,7 +21,7 @@ void print_help_cfg(char **argv) {
     fprintf(stderr, "Dump the Control Flow Graph of the SOURCE (Graphviz format).\n\n");
 
     fprintf(stderr, "Arguments:\n");
-    fprintf(stderr, "  SOURCE          Path to the source file (While language).\n");
+    fprintf(stderr, "  SOURCE          Path to the source file (While language), '-' for the standard input.\n");
 }
 
 void print_help_analyze(char **argv) {
@@ -51,12 +51,24 @@ void print_help_analyze_pinterval(char **argv) {
     fprintf(stderr, "  --m INT          Lower bound of the domain (default: -INF).\n");
     fprintf(stderr, "  --n INT          Upper bound of the domain (default: +INF).\n");
     fprintf(stderr, "  --wdelay N       Number of steps to wait before applying widening (default: disabled).\n");
-    fprintf(stderr, "  --dsteps N       Number of descending steps (narrowing) (default: 0).\n");
+    fprintf(stderr, "  --dsteps N       Maximum number of descending steps (narrowing) of each loop (default: 0).\n");
     fprintf(stderr, "  --init FILE      Initial abstract state configuration for the entry point,\n");
-    fprintf(stderr, "                   each abstract domain has its own representation (default: TOP).\n\n");
+    fprintf(stderr, "                   each abstract domain has its own representation (default: TOP).\n");
+    fprintf(stderr, "  --strategy S     Fixpoint iteration strategy: 'worklist', 'wto' or 'async' (default: worklist).\n");
+    fprintf(stderr, "                   'async' is experimental: the points are updated concurrently by the threads,\n");
+    fprintf(stderr, "                   with widening the results can differ between runs.\n");
+    fprintf(stderr, "  --contract-skips S\n");
+    fprintf(stderr, "                   Contract the skip nodes of the CFG before the analysis: 'on' or 'off' (default: off),\n");
+    fprintf(stderr, "                   the states of all the program points are reported anyway.\n");
+    fprintf(stderr, "  --basic-blocks S Coalesce the straight-line assignments into basic blocks: 'on' or 'off' (default: off),\n");
+    fprintf(stderr, "                   the states of all the program points are reported anyway.\n");
+    fprintf(stderr, "                   The order of the updates changes, so with widening the results can differ.\n");
+    fprintf(stderr, "  --threads N      Number of threads of the worklist (and async) strategy, the independent loops\n");
+    fprintf(stderr, "                   are solved in parallel with the same results (default: 1).\n");
+    fprintf(stderr, "                   The 'wto' strategy is sequential and does not accept more than 1 thread.\n\n");
 
     fprintf(stderr, "Arguments:\n");
-    fprintf(stderr, "  SOURCE          Path to the source file (While language).\n\n");
+    fprintf(stderr, "  SOURCE          Path to the source file (While language), '-' for the standard input.\n\n");
 
     fprintf(stderr, "Notes on (m,n):\n");
     fprintf(stderr, "  (-INF,+INF)     Standard interval abstract domain.\n");
@@ -84,6 +96,36 @@ bool parse_string(const char *arg, void *c) {
     return true;
 }
 
+bool parse_strategy(const char *arg, void *s) {
+    enum While_Analyzer_Strategy *strategy = (enum While_Analyzer_Strategy *)s;
+    if (strcmp(arg, "worklist") == 0) {
+        *strategy = WHILE_ANALYZER_STRATEGY_WORKLIST;
+        return true;
+    }
+    if (strcmp(arg, "wto") == 0) {
+        *strategy = WHILE_ANALYZER_STRATEGY_WTO;
+        return true;
+    }
+    if (strcmp(arg, "async") == 0) {
+        *strategy = WHILE_ANALYZER_STRATEGY_ASYNC;
+        return true;
+    }
+    return false;
+}
+
+bool parse_switch(const char *arg, void *b) {
+    bool *value = (bool *)b;
+    if (strcmp(arg, "on") == 0) {
+        *value = true;
+        return true;
+    }
+    if (strcmp(arg, "off") == 0) {
+        *value = false;
+        return true;
+    }
+    return false;
+}
+
 typedef bool (*parse_opt_val)(const char *arg, void *n);
 bool get_opt(void *opt_val, const char *opt, bool *opt_found, parse_opt_val parse, int i, int argc, char **argv) {
     if (strcmp(opt, argv[i]) == 0) {
@@ -153,6 +195,8 @@ void handle_analyze_cmd(int argc, char **argv) {
             .widening_delay = SIZE_MAX,
             .descending_steps = 0,
             .init_state_path = NULL,
+            .strategy = WHILE_ANALYZER_STRATEGY_WORKLIST,
+            .threads = 1,
         };
 
         const char *src_path = argv[3];
@@ -162,7 +206,11 @@ void handle_analyze_cmd(int argc, char **argv) {
         bool wdelay_found = false;
         bool dsteps_found = false;
         bool init_found = false;
-        
+        bool strategy_found = false;
+        bool contract_found = false;
+        bool blocks_found = false;
+        bool threads_found = false;
+
         // Check options
         for (int i = 4; i < argc; i+=2) {
 
@@ -181,11 +229,29 @@ void handle_analyze_cmd(int argc, char **argv) {
             if (get_opt(&exec_opt.init_state_path, "--init", &init_found, parse_string, i, argc, argv)) {
                 continue;
             }
+            if (get_opt(&exec_opt.strategy, "--strategy", &strategy_found, parse_strategy, i, argc, argv)) {
+                continue;
+            }
+            if (get_opt(&opt.contract_skips, "--contract-skips", &contract_found, parse_switch, i, argc, argv)) {
+                continue;
+            }
+            if (get_opt(&opt.basic_blocks, "--basic-blocks", &blocks_found, parse_switch, i, argc, argv)) {
+                continue;
+            }
+            if (get_opt(&exec_opt.threads, "--threads", &threads_found, parse_size, i, argc, argv)) {
+                continue;
+            }
 
             fprintf(stderr, "Parsing error: (%s) invalid option.\n", argv[i]);
             exit(1);
         }
 
+        // The WTO strategy is sequential
+        if (exec_opt.strategy == WHILE_ANALYZER_STRATEGY_WTO && exec_opt.threads > 1) {
+            fprintf(stderr, "Parsing error: (--threads) not supported by the 'wto' strategy.\n");
+            exit(1);
+        }
+
         // Analysis
         printf("\n/========================\\\n");
         printf("|    Analysis options    |\n");
@@ -212,11 +278,30 @@ void handle_analyze_cmd(int argc, char **argv) {
         } else {
             printf("  init   : %s\n", exec_opt.init_state_path);
         }
+        if (exec_opt.strategy == WHILE_ANALYZER_STRATEGY_WTO) {
+            printf("  strat  : wto\n");
+        } else if (exec_opt.strategy == WHILE_ANALYZER_STRATEGY_ASYNC) {
+            printf("  strat  : async\n");
+        } else {
+            printf("  strat  : worklist\n");
+        }
+        if (opt.contract_skips) {
+            printf("  skips  : contracted\n");
+        } else {
+            printf("  skips  : kept\n");
+        }
+        if (opt.basic_blocks) {
+            printf("  blocks : coalesced\n");
+        } else {
+            printf("  blocks : off\n");
+        }
+        printf("  threads: %zu\n", exec_opt.threads);
         printf("\\========================/\n\n");
 
         While_Analyzer *wa = while_analyzer_init(src_path, &opt);
         while_analyzer_exec(wa, &exec_opt);
         while_analyzer_states_dump(wa, stdout);
+        printf("Iterations: %zu\n", while_analyzer_iterations(wa));
         while_analyzer_free(wa);
     }
     else {
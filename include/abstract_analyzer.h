@@ -3,6 +3,7 @@
 
 #include <stdio.h>
 #include <stdint.h>
+#include <stdbool.h>
 
 typedef struct While_Analyzer While_Analyzer;
 
@@ -12,6 +13,17 @@ enum Abstract_Dom_Type {
 
 typedef struct {
     enum Abstract_Dom_Type type;
+
+    // Contract the skip nodes of the CFG before the analysis, so the fixpoint computation
+    // has less program points. The states of the contracted points are computed when dumped.
+    bool contract_skips;
+
+    // Coalesce the straight-line chains of assignments into basic blocks, executed by a single
+    // transfer function. The states inside the blocks are computed when dumped.
+    // Without widening the states are the same, with widening they can differ
+    // (the loop heads are updated in a different order, so the widening delay expires at other states).
+    bool basic_blocks;
+
     union {
         struct {
             int64_t m;
@@ -20,16 +32,40 @@ typedef struct {
     } as;
 } While_Analyzer_Opt;
 
+// Iteration strategy used for computing the fixpoint
+enum While_Analyzer_Strategy {
+    // Worklist seeded with the entry point, widening is applied on the loop heads
+    WHILE_ANALYZER_STRATEGY_WORKLIST,
+
+    // Recursive strategy over a Weak Topological Ordering of the CFG (Bourdoncle):
+    // the inner components are stabilized first and widening is applied only on the component heads
+    WHILE_ANALYZER_STRATEGY_WTO,
+
+    // Experimental: 'threads' workers update concurrently the points of a shared worklist.
+    // The order of the updates is not deterministic, so with widening the states can differ between runs.
+    WHILE_ANALYZER_STRATEGY_ASYNC,
+};
+
 typedef struct {
     // Number of steps to wait before applying the widening,
     // if the value is SIZE_MAX then it is disabled.
     size_t widening_delay;
 
-    // Number of descending steps (narrowing)
+    // Maximum number of descending steps (narrowing) of each widening point (0: no descending phase).
+    // The descending phase ends earlier if the states are stable.
     size_t descending_steps;
 
     // Initial abstract state conf file path for the entry point (each domain has its own representation)
     const char *init_state_path;
+
+    // Fixpoint iteration strategy (default: worklist)
+    enum While_Analyzer_Strategy strategy;
+
+    // Number of threads of the worklist strategy, the strongly connected components of the CFG
+    // are solved in parallel as soon as their predecessors are solved (0 or 1: sequential).
+    // The states are the same as the sequential ones.
+    // It is also the number of workers of the asynchronous strategy, the WTO strategy ignores it.
+    size_t threads;
 } While_Analyzer_Exec_Opt;
 
 // Inits the analyzer structure based on the specific domain configuration
@@ -41,6 +77,9 @@ void while_analyzer_free(While_Analyzer *wa);
 // Execute the analysis
 void while_analyzer_exec(While_Analyzer *wa, const While_Analyzer_Exec_Opt *opt);
 
+// Number of program point updates done by the last analysis (narrowing excluded)
+size_t while_analyzer_iterations(const While_Analyzer *wa);
+
 // Dump the abstract states of every program point through 'fp'
 void while_analyzer_states_dump(const While_Analyzer *wa, FILE *fp);
 
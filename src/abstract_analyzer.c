@@ -1,7 +1,10 @@
 #include "../include/abstract_analyzer.h"
 #include "lang/cfg.h"
+#include "lang/wto.h"
+#include "lang/scc.h"
 #include "lang/parser.h"
 #include "common.h"
+#include "source.h"
 #include "abstract_domain.h"
 #include "domain/abstract_interval_domain.h"
 #include "domain/wrappers/abstract_interval_domain_wrap.h"
@@ -10,11 +13,19 @@
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <pthread.h>
+#include <sched.h>
 
 struct While_Analyzer {
-    // Control Flow Graph of the input program, contains the program points (the nodes)
+    // Control Flow Graph analyzed, contains the program points (the nodes)
     CFG *cfg;
 
+    // Control Flow Graph of the input program, the program points reported to the user.
+    // When the CFG is simplified (skip contraction, basic blocks) 'point[i]' is the node of 'cfg'
+    // for the program point i (SIZE_MAX if removed), else 'point' is NULL and 'cfg' is the same graph.
+    CFG *program_cfg;
+    size_t *point;
+
     // Every element is the pointer to a state.
     // So state[0] is the pointer to the state of the first program point
     // (the first node of the cfg, cfg->nodes[0]),
@@ -24,54 +35,49 @@ struct While_Analyzer {
     // Abstract domain context
     Abstract_Dom_Ctx *ctx;
 
+    // Variables of the program, the variable nodes in the CFG commands contain their index
+    Variables vars;
+
     // Source code of the input program
-    char *src;
+    Source src;
+
+    // Memory of the AST and of the CFG
+    Arena arena;
 
     // Operations vtable
     const Abstract_Dom_Ops *ops;
-};
-
-/* ====================================== Utils ====================================== */
-
-static char *read_file(const char *src_path) {
-    // Open source file
-    FILE *fp = fopen(src_path, "r");
 
-    if (fp == NULL) {
-        fprintf(stderr, "[ERROR]: File %s not found.\n", src_path);
-        exit(1);
-    }
-
-    // Getting file size
-    fseek(fp, 0, SEEK_END);
-    long file_size = ftell(fp);
-    fseek(fp, 0, SEEK_SET);
-
-    // Copy the text in a buffer
-    char *src = xmalloc((file_size + 1)*sizeof(char));
-    fread(src, file_size, 1, fp);
-    src[file_size] = '\0';
-    fclose(fp);
-
-    return src;
-}
-
-/* /////////////////////////////////////////////////////////////////////////////////// */
+    // Number of program point updates done by the last analysis
+    size_t iterations;
+
+    // Transfer cache, valid only during 'while_analyzer_exec'.
+    //
+    // Indexed as 'cfg->edges':
+    // 'edge_state' is the output of its transfer function and 'edge_version' is
+    // the version of the source state used for computing it.
+    // The version of a program point state is incremented every time the state changes,
+    // so a transfer function is re-executed only if its source state changed.
+    Abstract_State **edge_state;
+    size_t *edge_version;
+    size_t *version;
+
+    // Buffer for computing a new state and temporary memory of the transfer functions,
+    // valid only during 'while_analyzer_exec'
+    Abstract_State *scratch;
+    Abstract_Exec_Buf *exec_buf;
+};
 
 /* ============================== Variables collection =============================== */
 
-static void vars_collect(While_Analyzer *wa, Variables *vars) {
-    Lexer *lex = lex_init(wa->src);
+static void vars_collect(const Lexer *lex, Variables *vars) {
+    size_t count = 0;
+    const Token *tokens = lex_tokens(lex, &count);
 
-    Token t = lex_next(lex);
-    while (t.type != TOKEN_EOF) {
-        if (t.type == TOKEN_VAR) {
-            vars_push_unique(vars, t.as.str);
+    for (size_t i = 0; i < count; ++i) {
+        if (tokens[i].type == TOKEN_VAR) {
+            vars_intern(vars, tokens[i].as.str);
         }
-        t = lex_next(lex);
     }
-
-    lex_free(lex);
 }
 
 /* /////////////////////////////////////////////////////////////////////////////////// */
@@ -79,154 +85,209 @@ static void vars_collect(While_Analyzer *wa, Variables *vars) {
 
 /* ================================ Constant collection =============================== */
 
-static int int64_compare(const void *a, const void *b) {
-    const int64_t *a_int = (const int64_t *) a;
-    const int64_t *b_int = (const int64_t *) b;
-
-    if (*b_int < *a_int) {
-        return 1;
-    } else if (*b_int > *a_int) {
-        return -1;
-    } else {
-        return 0;
-    }
-}
-
-static void constant_collect(const char *src_path, Constants *constants, size_t vars_count) {
+// Collect the constants of the program in 'wa' (its CFG and variables must be already built).
+// Besides the numbers in the source, the constant propagation domain Int(1,-1) is run
+// on the program CFG with its own context and states, and the constants found are added.
+static void constant_collect(const While_Analyzer *wa, const Lexer *lex, Constants *constants) {
 
     // Collect constants in the source file
-    char *src = read_file(src_path);
-    Lexer *lex = lex_init(src);
+    size_t count = 0;
+    const Token *tokens = lex_tokens(lex, &count);
 
-    Token t = lex_next(lex);
-    while (t.type != TOKEN_EOF) {
-        if (t.type == TOKEN_NUM) {
-            constant_push_unique(constants, t.as.num);
+    for (size_t i = 0; i < count; ++i) {
+        if (tokens[i].type == TOKEN_NUM) {
+            constant_push(constants, tokens[i].as.num);
         }
-        t = lex_next(lex);
     }
 
-    lex_free(lex);
-    free(src);
-
-    // Using constant propagation domain for getting other constants
-    While_Analyzer_Opt opt = {
-        .type = WHILE_ANALYZER_PARAMETRIC_INTERVAL,
-        .as = {
-            .parametric_interval = {
-                .m = 1,
-                .n = -1,
-            },
-        },
-    };
+    // Using constant propagation domain for getting other constants.
+    // The analyzer shares the program CFG and variables of 'wa', only the states are its own.
+    While_Analyzer constant_dom = *wa;
+    constant_dom.cfg = wa->program_cfg;
+    constant_dom.point = NULL;
+
+    Constants c = {0};
+    constant_push(&c, INTERVAL_MIN_INF);
+    constant_push(&c, INTERVAL_PLUS_INF);
+    constant_dom.ctx = abstract_interval_ctx_init(1, -1, wa->vars, c);
+    constant_dom.ops = &abstract_interval_ops;
+
+    constant_dom.state = xmalloc(sizeof(Abstract_State *) * constant_dom.cfg->count);
+    for (size_t i = 0; i < constant_dom.cfg->count; ++i) {
+        constant_dom.state[i] = (Abstract_State*) abstract_interval_state_init(constant_dom.ctx);
+    }
 
     While_Analyzer_Exec_Opt exec_opt = {
         .widening_delay = SIZE_MAX,
         .descending_steps = 0,
     };
+    while_analyzer_exec(&constant_dom, &exec_opt);
 
-    While_Analyzer *constant_dom = while_analyzer_init(src_path, &opt);
-    while_analyzer_exec(constant_dom, &exec_opt);
-
-    for (size_t state = 0; state < constant_dom->cfg->count; ++state) {
-        for (size_t j = 0; j < vars_count; ++j) {
-            Interval i = ((Interval *)constant_dom->state[state])[j];
+    for (size_t state = 0; state < constant_dom.cfg->count; ++state) {
+        for (size_t j = 0; j < wa->vars.count; ++j) {
+            Interval i = ((Interval *)constant_dom.state[state])[j];
             if (i.type != INTERVAL_BOTTOM && i.a != INTERVAL_MIN_INF) {
-                constant_push_unique(constants, i.a);
+                constant_push(constants, i.a);
             }
         }
     }
 
-    while_analyzer_free(constant_dom);
+    for (size_t i = 0; i < constant_dom.cfg->count; ++i) {
+        abstract_interval_state_free((Interval *)constant_dom.state[i]);
+    }
+    free(constant_dom.state);
+    abstract_interval_ctx_free(constant_dom.ctx);
 }
 
 /* /////////////////////////////////////////////////////////////////////////////////// */
 
 /* ================================== Worklist queue ================================== */
 
-// The worklist is simply a queue (implemented as doubly linked list)
-typedef struct Program_Point_Node Program_Point_Node;
-struct Program_Point_Node {
-    Program_Point_Node *next;
-    Program_Point_Node *prev;
-    size_t id;
-};
-
+// The worklist is a priority queue (binary min-heap) of program points,
+// the priority of a point is its position in the reverse postorder of the CFG.
+// So (apart from the back edges) the predecessors are processed before their successors.
+//
+// All the memory is allocated once in 'worklist_init', the heap can't grow over its capacity
+// because the 'queued' bitmap keeps every point at most once in the queue.
 typedef struct {
-    Program_Point_Node *head;
-    Program_Point_Node *tail;
+    size_t *heap;
+    size_t count;
+
+    // Reverse postorder position of each program point (not owned by the queue)
+    const size_t *rank;
+
+    // Bitmap of the points currently in the queue
+    uint64_t *queued;
 } Worklist;
 
-static void worklist_init(Worklist *wl) {
-    wl->head = NULL;
-    wl->tail = NULL;
+// Compute the reverse postorder position of the nodes reachable from P0 (iterative DFS).
+//
+// The edges are explored from the last one, so the exit edge of a loop head is visited before its body:
+// in reverse postorder the loop body comes before the code that follows the loop,
+// hence a loop is stabilized before propagating its result.
+static void reverse_postorder(const CFG *cfg, size_t *rank) {
+    bool *visited = xcalloc(cfg->count, sizeof(bool));
+
+    // Stack of (node, next edge to explore)
+    size_t *stack = xmalloc(sizeof(size_t) * cfg->count);
+    size_t *next_edge = xmalloc(sizeof(size_t) * cfg->count);
+    size_t stack_count = 0;
+
+    // Unreachable nodes are never enqueued
+    for (size_t i = 0; i < cfg->count; ++i) {
+        rank[i] = SIZE_MAX;
+    }
+
+    size_t postorder = cfg->count;
+    stack[stack_count] = 0;
+    next_edge[stack_count] = cfg->nodes[0].edge_count;
+    stack_count++;
+    visited[0] = true;
+
+    while (stack_count != 0) {
+        size_t top = stack_count - 1;
+        size_t id = stack[top];
+
+        if (next_edge[top] == 0) {
+            rank[id] = --postorder;
+            stack_count--;
+            continue;
+        }
+
+        size_t dst = cfg->nodes[id].edges[--next_edge[top]].dst;
+        if (!visited[dst]) {
+            visited[dst] = true;
+            stack[stack_count] = dst;
+            next_edge[stack_count] = cfg->nodes[dst].edge_count;
+            stack_count++;
+        }
+    }
+
+    free(visited);
+    free(stack);
+    free(next_edge);
 }
 
-static void worklist_enqueue(Worklist *wl, size_t point_id) {
-    Program_Point_Node *node = xmalloc(sizeof(*node));
-    node->id = point_id;
+// Init an empty queue of at most 'capacity' points, with ids lower than 'count'
+static void worklist_init(Worklist *wl, size_t capacity, size_t count, const size_t *rank) {
+    wl->heap = xmalloc(sizeof(size_t) * (capacity + 1));
+    wl->count = 0;
+    wl->rank = rank;
+    wl->queued = xcalloc((count + 63) / 64, sizeof(uint64_t));
+}
 
-    if (wl->head == NULL && wl->tail == NULL) {
-        wl->head = node;
-        wl->tail = node;
-        node->next = NULL;
-        node->prev = NULL;
+static void worklist_free(Worklist *wl) {
+    free(wl->heap);
+    free(wl->queued);
+}
+
+static bool worklist_empty(const Worklist *wl) {
+    return wl->count == 0;
+}
+
+static void worklist_enqueue(Worklist *wl, size_t point_id) {
+    uint64_t mask = (uint64_t)1 << (point_id % 64);
+    if (wl->queued[point_id / 64] & mask) {
+        return;
     }
-    else {
-        node->next = wl->head;
-        node->prev = NULL;
-        wl->head->prev = node;
-        wl->head = node;
+    wl->queued[point_id / 64] |= mask;
+
+    // Sift up
+    size_t i = wl->count++;
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        if (wl->rank[wl->heap[parent]] <= wl->rank[point_id]) break;
+        wl->heap[i] = wl->heap[parent];
+        i = parent;
     }
+    wl->heap[i] = point_id;
 }
 
 static size_t worklist_dequeue(Worklist *wl) {
-    if (wl->tail == NULL) {
+    if (wl->count == 0) {
         fprintf(stderr, "[ERROR]: Trying to dequeue from empty queue.\n");
         exit(1);
     }
-    else {
-        size_t id = wl->tail->id;
-
-        Program_Point_Node *to_free = wl->tail;
 
-        if (wl->head == wl->tail) {
-            // There is only one node
-            wl->head = NULL;
-            wl->tail = NULL;
-        } else {
-            // Set the tail to the prev element (there are almost 2 nodes)
-            wl->tail = to_free->prev;
-            wl->tail->next = NULL;
+    size_t id = wl->heap[0];
+    wl->queued[id / 64] &= ~((uint64_t)1 << (id % 64));
+
+    // Move the last element on the root and sift down
+    size_t last = wl->heap[--wl->count];
+    size_t i = 0;
+    for (;;) {
+        size_t child = 2*i + 1;
+        if (child >= wl->count) break;
+        if (child + 1 < wl->count && wl->rank[wl->heap[child + 1]] < wl->rank[wl->heap[child]]) {
+            child++;
         }
-
-        free(to_free);
-        return id;
+        if (wl->rank[last] <= wl->rank[wl->heap[child]]) break;
+        wl->heap[i] = wl->heap[child];
+        i = child;
     }
+    wl->heap[i] = last;
+
+    return id;
 }
 /* /////////////////////////////////////////////////////////////////////////////////// */
 
 
 /* ======================== Parametric interval domain Int(m,n) ======================= */
-static void while_analyzer_init_parametric_interval(While_Analyzer *wa, const char *src_path, int64_t m, int64_t n) {
-
-    // Collect variables in the source
-    Variables vars = {0};
-    vars_collect(wa, &vars);
+static void while_analyzer_init_parametric_interval(While_Analyzer *wa, const Lexer *lex, int64_t m, int64_t n) {
 
     // Dynamic array of (sorted) constants, by default with -INF and +INF as widening threshold
     Constants c = {0};
-    constant_push_unique(&c, INTERVAL_MIN_INF);
-    constant_push_unique(&c, INTERVAL_PLUS_INF);
+    constant_push(&c, INTERVAL_MIN_INF);
+    constant_push(&c, INTERVAL_PLUS_INF);
 
     if (m <= n) {
-        constant_collect(src_path, &c, vars.count);
+        constant_collect(wa, lex, &c);
     }
 
-    qsort(c.data, c.count, sizeof(int64_t), int64_compare);
+    constants_sort_unique(&c);
 
     // Domain context setup
-    wa->ctx = abstract_interval_ctx_init(m, n, vars, c);
+    wa->ctx = abstract_interval_ctx_init(m, n, wa->vars, c);
 
     // Alloc abstract states for all program points
     wa->state = malloc(sizeof(Abstract_State *) * wa->cfg->count);
@@ -241,62 +302,865 @@ static void while_analyzer_init_parametric_interval(While_Analyzer *wa, const ch
 
 /* /////////////////////////////////////////////////////////////////////////////////// */
 
-// Apply the abstract tranfer function for each node predecessor and then returns the union
+// Apply the abstract tranfer function for each node predecessor and then writes the union in 'dst'.
+// The transfer functions are executed only on the edges whose source state changed,
+// the other results are taken from the transfer cache.
 // NOTE: This function assumes that the 'wa->cfg->nodes[id]' has at least one predecessor.
-static Abstract_State *abstract_transfer_union(const While_Analyzer *wa, size_t id) {
+static void abstract_transfer_union(const While_Analyzer *wa, size_t id, Abstract_State *dst) {
+    const CFG_Node *node = &wa->cfg->nodes[id];
+
+    for (size_t i = 0; i < node->in_count; ++i) {
+        size_t edge = node->in_edges[i];
+        size_t pred = wa->cfg->edges[edge].src;
+
+        // Apply the abstract transfer function only if the predecessor state changed
+        if (wa->edge_version[edge] != wa->version[pred]) {
+            const Bytecode *command = &wa->cfg->edges[edge].bytecode;
+            if (wa->edge_state[edge] == NULL) {
+                wa->edge_state[edge] = wa->ops->state_init(wa->ctx);
+            }
+            wa->ops->exec_command_into(wa->ctx, wa->edge_state[edge], wa->state[pred], command, wa->exec_buf);
+            wa->edge_version[edge] = wa->version[pred];
+        }
+
+        // Union of the results
+        if (i == 0) {
+            wa->ops->state_copy(wa->ctx, dst, wa->edge_state[edge]);
+        } else {
+            wa->ops->union_into(wa->ctx, dst, dst, wa->edge_state[edge]);
+        }
+    }
+}
+
+// Replace the state of 'id' with the new state in 'wa->scratch' (swapping the buffers)
+static void replace_state(While_Analyzer *wa, size_t id) {
+    Abstract_State *prev = wa->state[id];
+    wa->state[id] = wa->scratch;
+    wa->scratch = prev;
+    wa->version[id]++;
+}
+
+// Recompute the state of the program point 'id' from its predecessors,
+// applying the widening if requested. Returns true if the state changed.
+static bool update_state(While_Analyzer *wa, size_t id, bool widening) {
+    wa->iterations++;
+
+    // Union of the preds transfer functions
+    abstract_transfer_union(wa, id, wa->scratch);
+
+    if (widening) {
+        wa->ops->widening_into(wa->ctx, wa->scratch, wa->state[id], wa->scratch);
+    }
+
+    bool state_changed = !wa->ops->state_equal(wa->ctx, wa->state[id], wa->scratch);
+    if (state_changed) {
+        replace_state(wa, id);
+    }
+
+    return state_changed;
+}
+
+// Dequeue the points until the worklist is empty, updating their states.
+// If 'component' is not NULL only the successors in the component 'c' are enqueued.
+static void worklist_solve(While_Analyzer *wa, const While_Analyzer_Exec_Opt *opt, Worklist *wl, size_t *step_count, const size_t *component, size_t c) {
+    while (!worklist_empty(wl)) {
+        size_t id = worklist_dequeue(wl);
+        CFG_Node node = wa->cfg->nodes[id];
+        step_count[id]++;
+
+        if (id != 0) {
+            // Apply widening if we are on a widening point
+            bool widening = node.is_while && step_count[id] > opt->widening_delay;
+
+            // If state changed signal the node dependencies
+            if (update_state(wa, id, widening)) {
+                for (size_t i = 0; i < node.edge_count; ++i) {
+                    size_t dep = node.edges[i].dst;
+                    if (component == NULL || component[dep] == c) {
+                        worklist_enqueue(wl, dep);
+                    }
+                }
+            }
+        }
+    }
+}
+
+static void exec_worklist(While_Analyzer *wa, const While_Analyzer_Exec_Opt *opt, size_t *step_count) {
+    size_t *rank = xmalloc(sizeof(size_t) * wa->cfg->count);
+    reverse_postorder(wa->cfg, rank);
+
+    Worklist wl = {0};
+    worklist_init(&wl, wa->cfg->count, wa->cfg->count, rank);
+
+    // Add the successors of the first program point (P0) to the worklist.
+    // Skipping the first because it will not change.
+    CFG_Node entry = wa->cfg->nodes[0];
+    for (size_t i = 0; i < entry.edge_count; ++i) {
+        worklist_enqueue(&wl, entry.edges[i].dst);
+    }
+
+    worklist_solve(wa, opt, &wl, step_count, NULL, 0);
+
+    worklist_free(&wl);
+    free(rank);
+}
+
+// Descending phase, starting from the post-fixpoint of the ascending phase.
+//
+// The worklist is seeded with the widening points, the points are recomputed from their predecessors
+// (applying the narrowing on the widening points) and only the successors of a decreased point are enqueued.
+// Every widening point is narrowed at most 'opt->descending_steps' times, and the phase ends
+// as soon as no state decreases.
+static void exec_narrowing(While_Analyzer *wa, const While_Analyzer_Exec_Opt *opt) {
+    if (opt->descending_steps == 0) {
+        return;
+    }
+
+    size_t *rank = xmalloc(sizeof(size_t) * wa->cfg->count);
+    reverse_postorder(wa->cfg, rank);
+
+    Worklist wl = {0};
+    worklist_init(&wl, wa->cfg->count, wa->cfg->count, rank);
+
+    // Number of times each widening point decreased
+    size_t *narrowing_count = xcalloc(wa->cfg->count, sizeof(size_t));
+
+    for (size_t id = 1; id < wa->cfg->count; ++id) {
+        if (wa->cfg->nodes[id].is_while && rank[id] != SIZE_MAX) {
+            worklist_enqueue(&wl, id);
+        }
+    }
+
+    while (!worklist_empty(&wl)) {
+        size_t id = worklist_dequeue(&wl);
+        CFG_Node node = wa->cfg->nodes[id];
+
+        if (id == 0 || (node.is_while && narrowing_count[id] >= opt->descending_steps)) {
+            continue;
+        }
+
+        abstract_transfer_union(wa, id, wa->scratch);
+
+        // Apply narrowing only on widening points
+        if (node.is_while) {
+            wa->ops->narrowing_into(wa->ctx, wa->scratch, wa->state[id], wa->scratch);
+        }
+
+        // The states only decrease, so if it changed its successors can decrease too
+        if (!wa->ops->state_equal(wa->ctx, wa->state[id], wa->scratch)) {
+            if (node.is_while) {
+                narrowing_count[id]++;
+            }
+            replace_state(wa, id);
+
+            for (size_t i = 0; i < node.edge_count; ++i) {
+                worklist_enqueue(&wl, node.edges[i].dst);
+            }
+        }
+    }
+
+    free(narrowing_count);
+    worklist_free(&wl);
+    free(rank);
+}
+
+/* ================================= Parallel worklist ================================ */
+
+// The strongly connected components of the CFG are solved in parallel by a pool of workers,
+// a component is ready as soon as all its predecessor components are solved.
+//
+// The CFG of a While program is reducible (a loop is entered only through its head),
+// so the components are intervals of the reverse postorder in topological order and
+// the sequential worklist also solves each of them after its predecessors.
+// A component is seeded with the points that have a predecessor outside it that changed,
+// and solved with the same reverse postorder priority: the states are the same as the sequential ones.
+//
+// Every point (with its state, version and in-edges transfer cache) is written only by the worker
+// solving its component, and its successors read it only after the component is solved.
+
+// Ready components of a worker: the owner pops from the back, the other workers steal from the front
+typedef struct {
+    pthread_mutex_t lock;
+    size_t *items;
+    size_t head;
+    size_t tail;
+    size_t capacity;
+} Task_Deque;
+
+typedef struct SCC_Pool SCC_Pool;
+
+typedef struct {
+    SCC_Pool *pool;
+    size_t id;
+    pthread_t thread;
+    Task_Deque deque;
+
+    // Shallow copy of the analyzer, with its own scratch buffers and iterations counter
+    While_Analyzer wa;
+
+    // Queue of the component being solved
+    Worklist wl;
+} SCC_Worker;
+
+struct SCC_Pool {
+    const SCC *scc;
+    const While_Analyzer_Exec_Opt *opt;
+    size_t *step_count;
+
+    SCC_Worker *workers;
+    size_t worker_count;
+
+    // Protects the fields below, 'cond' signals a new ready component or the end of the analysis
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+
+    // Number of predecessor components not yet solved of each component
+    size_t *waiting;
+
+    // Components not yet solved, and components in the deques
+    size_t remaining;
+    size_t ready;
+};
+
+static void task_deque_push(Task_Deque *dq, size_t c) {
+    pthread_mutex_lock(&dq->lock);
+    if (dq->tail >= dq->capacity) {
+        dq->capacity = dq->capacity == 0 ? 64 : dq->capacity * 2;
+        dq->items = xrealloc(dq->items, dq->capacity*sizeof(size_t));
+    }
+    dq->items[dq->tail++] = c;
+    pthread_mutex_unlock(&dq->lock);
+}
+
+// Take a component from the back ('steal' false) or from the front ('steal' true), returns false if empty
+static bool task_deque_take(Task_Deque *dq, size_t *c, bool steal) {
+    pthread_mutex_lock(&dq->lock);
+    bool found = dq->head < dq->tail;
+    if (found) {
+        *c = steal ? dq->items[dq->head++] : dq->items[--dq->tail];
+        if (dq->head == dq->tail) {
+            dq->head = 0;
+            dq->tail = 0;
+        }
+    }
+    pthread_mutex_unlock(&dq->lock);
+    return found;
+}
+
+// Solve the component 'c', its predecessor components are already solved
+static void scc_solve(SCC_Worker *w, size_t c) {
+    const SCC *scc = w->pool->scc;
+    While_Analyzer *wa = &w->wa;
+
+    // Seed with the points reached by P0 (as the sequential worklist) or by a changed point of another component
+    for (size_t k = scc->node_start[c]; k < scc->node_start[c + 1]; ++k) {
+        size_t id = scc->nodes[k];
+        const CFG_Node *node = &wa->cfg->nodes[id];
+
+        for (size_t i = 0; i < node->in_count; ++i) {
+            size_t pred = wa->cfg->edges[node->in_edges[i]].src;
+            if (pred == 0 || (scc->component[pred] != c && wa->version[pred] > 1)) {
+                worklist_enqueue(&w->wl, id);
+                break;
+            }
+        }
+    }
+
+    worklist_solve(wa, w->pool->opt, &w->wl, w->pool->step_count, scc->component, c);
+}
+
+static void *scc_worker_run(void *arg) {
+    SCC_Worker *w = arg;
+    SCC_Pool *pool = w->pool;
+
+    for (;;) {
+        // Own components first, then steal from the other workers
+        size_t c = 0;
+        bool found = task_deque_take(&w->deque, &c, false);
+        for (size_t i = 1; !found && i < pool->worker_count; ++i) {
+            found = task_deque_take(&pool->workers[(w->id + i) % pool->worker_count].deque, &c, true);
+        }
+
+        pthread_mutex_lock(&pool->lock);
+        if (!found) {
+            while (pool->ready == 0 && pool->remaining > 0) {
+                pthread_cond_wait(&pool->cond, &pool->lock);
+            }
+            bool done = pool->remaining == 0;
+            pthread_mutex_unlock(&pool->lock);
+
+            if (done) break;
+            continue;
+        }
+        pool->ready--;
+        pthread_mutex_unlock(&pool->lock);
+
+        scc_solve(w, c);
+
+        // Release the successor components whose predecessors are all solved
+        pthread_mutex_lock(&pool->lock);
+        pool->remaining--;
+        for (size_t i = pool->scc->succ_start[c]; i < pool->scc->succ_start[c + 1]; ++i) {
+            size_t succ = pool->scc->succ[i];
+            if (--pool->waiting[succ] == 0) {
+                task_deque_push(&w->deque, succ);
+                pool->ready++;
+            }
+        }
+        pthread_cond_broadcast(&pool->cond);
+        pthread_mutex_unlock(&pool->lock);
+    }
+
+    return NULL;
+}
+
+static void exec_worklist_parallel(While_Analyzer *wa, const While_Analyzer_Exec_Opt *opt, size_t *step_count) {
+    size_t *rank = xmalloc(sizeof(size_t) * wa->cfg->count);
+    reverse_postorder(wa->cfg, rank);
+
+    SCC *scc = scc_get(wa->cfg);
+
+    SCC_Pool pool = {
+        .scc = scc,
+        .opt = opt,
+        .step_count = step_count,
+        .worker_count = opt->threads,
+        .remaining = scc->count,
+        .ready = 0,
+    };
+    pthread_mutex_init(&pool.lock, NULL);
+    pthread_cond_init(&pool.cond, NULL);
+
+    pool.waiting = xmalloc(sizeof(size_t) * (scc->count + 1));
+    for (size_t c = 0; c < scc->count; ++c) {
+        pool.waiting[c] = scc->pred_count[c];
+    }
+
+    pool.workers = xcalloc(pool.worker_count, sizeof(SCC_Worker));
+    for (size_t i = 0; i < pool.worker_count; ++i) {
+        SCC_Worker *w = &pool.workers[i];
+        w->pool = &pool;
+        w->id = i;
+        pthread_mutex_init(&w->deque.lock, NULL);
+
+        w->wa = *wa;
+        w->wa.scratch = wa->ops->state_init(wa->ctx);
+        w->wa.exec_buf = wa->ops->exec_buf_init(wa->ctx);
+        w->wa.iterations = 0;
+        worklist_init(&w->wl, scc->max_size, wa->cfg->count, rank);
+    }
+
+    // The component of P0 is the only one without predecessors
+    task_deque_push(&pool.workers[0].deque, 0);
+    pool.ready = 1;
+
+    // The calling thread is the first worker
+    for (size_t i = 1; i < pool.worker_count; ++i) {
+        if (pthread_create(&pool.workers[i].thread, NULL, scc_worker_run, &pool.workers[i]) != 0) {
+            fprintf(stderr, "[ERROR]: Can not create the analysis threads.\n");
+            exit(1);
+        }
+    }
+    scc_worker_run(&pool.workers[0]);
+
+    // The deques are freed only after all the workers are done, they can still be stolen from
+    for (size_t i = 1; i < pool.worker_count; ++i) {
+        pthread_join(pool.workers[i].thread, NULL);
+    }
+
+    for (size_t i = 0; i < pool.worker_count; ++i) {
+        SCC_Worker *w = &pool.workers[i];
+        wa->iterations += w->wa.iterations;
+        wa->ops->state_free(w->wa.scratch);
+        wa->ops->exec_buf_free(w->wa.exec_buf);
+        worklist_free(&w->wl);
+        free(w->deque.items);
+        pthread_mutex_destroy(&w->deque.lock);
+    }
+
+    free(pool.workers);
+    free(pool.waiting);
+    pthread_mutex_destroy(&pool.lock);
+    pthread_cond_destroy(&pool.cond);
+    scc_free(scc);
+    free(rank);
+}
+
+/* /////////////////////////////////////////////////////////////////////////////////// */
+
+/* ================================= Asynchronous engine ============================== */
+
+// Experimental chaotic iteration: the workers pop the program points from a shared lock-free queue
+// and update them concurrently, so also the points of a single loop are updated in parallel.
+//
+// - A point is updated by one worker at a time, its 'Async_Status' is the lock of its step count,
+//   of its state buffer and of the transfer cache of its in-edges.
+// - The states are published swapping the pointer in 'wa->state' (then incrementing the version),
+//   so the other workers read the predecessor states without locks.
+// - The old states are freed with Epoch Based Reclamation: a worker announces the global epoch
+//   while it reads the predecessor states, and a state retired in the epoch E is reused only
+//   when the global epoch is E+2, so no worker can still be reading it.
+//
+// The order of the updates is not deterministic: with widening the states can be
+// different (but sound) from the sequential ones, without widening they are the same fixpoint.
+
+// Status of a program point, the transitions are atomic
+enum Async_Status {
+    ASYNC_IDLE,
+    ASYNC_QUEUED,
+    ASYNC_RUNNING,
+    ASYNC_RUNNING_DIRTY, // Enqueued again while running, it is queued when the update ends
+};
+
+// Bounded Multi-Producer Multi-Consumer queue (D. Vyukov): every cell has a sequence number
+// that says if it can be written (== position) or read (== position + 1) at a given position.
+// A point is at most once in the queue, so it never fills up with 'capacity' > 'cfg->count'
+// (a producer can only wait for a consumer that is still reading a cell).
+typedef struct {
+    size_t seq;
+    size_t id;
+} Async_Cell;
+
+typedef struct {
+    Async_Cell *cells;
+    size_t mask;
+    size_t enqueue_pos;
+    size_t dequeue_pos;
+} Async_Queue;
+
+// State retired in 'epoch'
+typedef struct {
+    Abstract_State *state;
+    size_t epoch;
+} Async_Retired;
+
+typedef struct Async_Pool Async_Pool;
+
+typedef struct {
+    Async_Pool *pool;
+    pthread_t thread;
+
+    // Announced epoch: '(epoch << 1) | 1' while reading the shared states, 0 otherwise
+    size_t announce;
+
+    // Retired states not yet reclaimable, and reclaimed states ready to be reused
+    Async_Retired *limbo;
+    size_t limbo_count;
+    size_t limbo_capacity;
+    Abstract_State **free_states;
+    size_t free_count;
+    size_t free_capacity;
+
+    // Temporary memory of the transfer functions
+    Abstract_Exec_Buf *exec_buf;
+
+    size_t iterations;
+} Async_Worker;
+
+struct Async_Pool {
+    While_Analyzer *wa;
+    const While_Analyzer_Exec_Opt *opt;
+    size_t *step_count;
+
+    Async_Queue queue;
+    unsigned char *status;
+
+    // Number of points queued or running, the analysis ends when it is 0
+    size_t active;
+
+    size_t epoch;
+    Async_Worker *workers;
+    size_t worker_count;
+};
+
+static void async_queue_init(Async_Queue *q, size_t count) {
+    size_t capacity = 64;
+    while (capacity <= count) {
+        capacity *= 2;
+    }
+
+    q->cells = xmalloc(sizeof(Async_Cell) * capacity);
+    for (size_t i = 0; i < capacity; ++i) {
+        q->cells[i].seq = i;
+    }
+    q->mask = capacity - 1;
+    q->enqueue_pos = 0;
+    q->dequeue_pos = 0;
+}
+
+static void async_queue_push(Async_Queue *q, size_t id) {
+    size_t pos = __atomic_load_n(&q->enqueue_pos, __ATOMIC_RELAXED);
+    Async_Cell *cell;
+    for (;;) {
+        cell = &q->cells[pos & q->mask];
+        ptrdiff_t diff = (ptrdiff_t)(__atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE) - pos);
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&q->enqueue_pos, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // The cell of the previous lap is still being read by a consumer that already took it
+            sched_yield();
+            pos = __atomic_load_n(&q->enqueue_pos, __ATOMIC_RELAXED);
+        } else {
+            pos = __atomic_load_n(&q->enqueue_pos, __ATOMIC_RELAXED);
+        }
+    }
+
+    cell->id = id;
+    __atomic_store_n(&cell->seq, pos + 1, __ATOMIC_RELEASE);
+}
+
+// Returns false if the queue is empty
+static bool async_queue_pop(Async_Queue *q, size_t *id) {
+    size_t pos = __atomic_load_n(&q->dequeue_pos, __ATOMIC_RELAXED);
+    Async_Cell *cell;
+    for (;;) {
+        cell = &q->cells[pos & q->mask];
+        ptrdiff_t diff = (ptrdiff_t)(__atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE) - (pos + 1));
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&q->dequeue_pos, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false;
+        } else {
+            pos = __atomic_load_n(&q->dequeue_pos, __ATOMIC_RELAXED);
+        }
+    }
+
+    *id = cell->id;
+    __atomic_store_n(&cell->seq, pos + q->mask + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+static void async_enqueue(Async_Pool *pool, size_t id) {
+    unsigned char status = __atomic_load_n(&pool->status[id], __ATOMIC_ACQUIRE);
+    for (;;) {
+        unsigned char next;
+        switch (status) {
+        case ASYNC_IDLE:    next = ASYNC_QUEUED; break;
+        case ASYNC_RUNNING: next = ASYNC_RUNNING_DIRTY; break;
+        default:            return; // Already going to be updated
+        }
+
+        if (__atomic_compare_exchange_n(&pool->status[id], &status, next, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            if (next == ASYNC_QUEUED) {
+                __atomic_add_fetch(&pool->active, 1, __ATOMIC_SEQ_CST);
+                async_queue_push(&pool->queue, id);
+            }
+            return;
+        }
+    }
+}
+
+// Advance the global epoch if all the workers reading the states announced the current one
+static void async_epoch_try_advance(Async_Pool *pool) {
+    size_t epoch = __atomic_load_n(&pool->epoch, __ATOMIC_SEQ_CST);
+    for (size_t i = 0; i < pool->worker_count; ++i) {
+        size_t announce = __atomic_load_n(&pool->workers[i].announce, __ATOMIC_SEQ_CST);
+        if ((announce & 1) && (announce >> 1) != epoch) {
+            return;
+        }
+    }
+    __atomic_compare_exchange_n(&pool->epoch, &epoch, epoch + 1, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
+// Add 's' to the states that the worker can reuse
+static void async_free_push(Async_Worker *w, Abstract_State *s) {
+    if (w->free_count >= w->free_capacity) {
+        w->free_capacity = w->free_capacity == 0 ? 64 : w->free_capacity * 2;
+        w->free_states = xrealloc(w->free_states, w->free_capacity*sizeof(Abstract_State *));
+    }
+    w->free_states[w->free_count++] = s;
+}
+
+// Retire the state 'old', and move to the free states the retired ones that are no longer read
+static void async_retire(Async_Worker *w, Abstract_State *old) {
+    Async_Pool *pool = w->pool;
+
+    if (w->limbo_count >= w->limbo_capacity) {
+        w->limbo_capacity = w->limbo_capacity == 0 ? 64 : w->limbo_capacity * 2;
+        w->limbo = xrealloc(w->limbo, w->limbo_capacity*sizeof(Async_Retired));
+    }
+    w->limbo[w->limbo_count].state = old;
+    w->limbo[w->limbo_count].epoch = __atomic_load_n(&pool->epoch, __ATOMIC_SEQ_CST);
+    w->limbo_count++;
+
+    async_epoch_try_advance(pool);
+    size_t epoch = __atomic_load_n(&pool->epoch, __ATOMIC_SEQ_CST);
+
+    // The limbo is in retire order, so the reclaimable states are a prefix
+    size_t reclaimed = 0;
+    while (reclaimed < w->limbo_count && w->limbo[reclaimed].epoch + 2 <= epoch) {
+        async_free_push(w, w->limbo[reclaimed].state);
+        reclaimed++;
+    }
+    memmove(w->limbo, w->limbo + reclaimed, (w->limbo_count - reclaimed)*sizeof(Async_Retired));
+    w->limbo_count -= reclaimed;
+}
+
+// Same as 'abstract_transfer_union', reading the predecessor states published by the other workers.
+// The version is read before the state: the cached result may be tagged with an older version
+// than the state used (and so recomputed once more), never with a newer one.
+static void async_transfer_union(const While_Analyzer *wa, size_t id, Abstract_State *dst, Abstract_Exec_Buf *exec_buf) {
+    const CFG_Node *node = &wa->cfg->nodes[id];
+
+    for (size_t i = 0; i < node->in_count; ++i) {
+        size_t edge = node->in_edges[i];
+        size_t pred = wa->cfg->edges[edge].src;
+
+        size_t version = __atomic_load_n(&wa->version[pred], __ATOMIC_ACQUIRE);
+        if (wa->edge_version[edge] != version) {
+            const Bytecode *command = &wa->cfg->edges[edge].bytecode;
+            const Abstract_State *pred_state = __atomic_load_n(&wa->state[pred], __ATOMIC_ACQUIRE);
+            if (wa->edge_state[edge] == NULL) {
+                wa->edge_state[edge] = wa->ops->state_init(wa->ctx);
+            }
+            wa->ops->exec_command_into(wa->ctx, wa->edge_state[edge], pred_state, command, exec_buf);
+            wa->edge_version[edge] = version;
+        }
+
+        if (i == 0) {
+            wa->ops->state_copy(wa->ctx, dst, wa->edge_state[edge]);
+        } else {
+            wa->ops->union_into(wa->ctx, dst, dst, wa->edge_state[edge]);
+        }
+    }
+}
+
+// Update the point 'id', the caller is the only worker running it
+static void async_update(Async_Worker *w, size_t id) {
+    Async_Pool *pool = w->pool;
+    While_Analyzer *wa = pool->wa;
     CFG_Node node = wa->cfg->nodes[id];
-    Abstract_State **states = xmalloc(sizeof(Abstract_State *) * node.preds_count);
 
-    // Apply the abstract transfer function for each predecessor
-    for (size_t i = 0; i < node.preds_count; ++i) {
-        size_t pred = node.preds[i];
-        CFG_Edge edge;
+    pool->step_count[id]++;
+    if (id == 0) {
+        return;
+    }
+    w->iterations++;
+
+    Abstract_State *next = w->free_count > 0 ? w->free_states[--w->free_count] : wa->ops->state_init(wa->ctx);
+    Abstract_State *prev = wa->state[id];
+
+    // Reading the predecessor states
+    size_t epoch = __atomic_load_n(&pool->epoch, __ATOMIC_SEQ_CST);
+    __atomic_store_n(&w->announce, (epoch << 1) | 1, __ATOMIC_SEQ_CST);
+    async_transfer_union(wa, id, next, w->exec_buf);
+    __atomic_store_n(&w->announce, 0, __ATOMIC_SEQ_CST);
+
+    if (node.is_while && pool->step_count[id] > pool->opt->widening_delay) {
+        wa->ops->widening_into(wa->ctx, next, prev, next);
+    }
+
+    if (wa->ops->state_equal(wa->ctx, prev, next)) {
+        async_free_push(w, next);
+        return;
+    }
+
+    // Publish the new state and then its version
+    __atomic_store_n(&wa->state[id], next, __ATOMIC_RELEASE);
+    __atomic_add_fetch(&wa->version[id], 1, __ATOMIC_RELEASE);
+    async_retire(w, prev);
+
+    for (size_t i = 0; i < node.edge_count; ++i) {
+        async_enqueue(pool, node.edges[i].dst);
+    }
+}
 
-        if (wa->cfg->nodes[pred].edges[0].dst == id) {
-            edge = wa->cfg->nodes[pred].edges[0];
+static void *async_worker_run(void *arg) {
+    Async_Worker *w = arg;
+    Async_Pool *pool = w->pool;
+
+    for (;;) {
+        size_t id;
+        if (!async_queue_pop(&pool->queue, &id)) {
+            if (__atomic_load_n(&pool->active, __ATOMIC_SEQ_CST) == 0) break;
+            sched_yield();
+            continue;
+        }
+
+        __atomic_store_n(&pool->status[id], ASYNC_RUNNING, __ATOMIC_RELEASE);
+        async_update(w, id);
+
+        // Queue it again if it was enqueued while running
+        unsigned char status = ASYNC_RUNNING;
+        if (__atomic_compare_exchange_n(&pool->status[id], &status, ASYNC_IDLE, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            __atomic_sub_fetch(&pool->active, 1, __ATOMIC_SEQ_CST);
         } else {
-            edge = wa->cfg->nodes[pred].edges[1];
+            __atomic_store_n(&pool->status[id], ASYNC_QUEUED, __ATOMIC_RELEASE);
+            async_queue_push(&pool->queue, id);
         }
+    }
 
-        states[i] = wa->ops->exec_command(wa->ctx, wa->state[pred], edge.command);
+    return NULL;
+}
+
+static void exec_async(While_Analyzer *wa, const While_Analyzer_Exec_Opt *opt, size_t *step_count) {
+    Async_Pool pool = {
+        .wa = wa,
+        .opt = opt,
+        .step_count = step_count,
+        .active = 0,
+        .epoch = 0,
+        .worker_count = opt->threads > 1 ? opt->threads : 1,
+    };
+    async_queue_init(&pool.queue, wa->cfg->count);
+    pool.status = xcalloc(wa->cfg->count, sizeof(unsigned char));
+    pool.workers = xcalloc(pool.worker_count, sizeof(Async_Worker));
+    for (size_t i = 0; i < pool.worker_count; ++i) {
+        pool.workers[i].pool = &pool;
+        pool.workers[i].exec_buf = wa->ops->exec_buf_init(wa->ctx);
+    }
+
+    // Add the successors of the first program point (P0) to the worklist
+    CFG_Node entry = wa->cfg->nodes[0];
+    for (size_t i = 0; i < entry.edge_count; ++i) {
+        async_enqueue(&pool, entry.edges[i].dst);
+    }
+
+    // The calling thread is the first worker
+    for (size_t i = 1; i < pool.worker_count; ++i) {
+        if (pthread_create(&pool.workers[i].thread, NULL, async_worker_run, &pool.workers[i]) != 0) {
+            fprintf(stderr, "[ERROR]: Can not create the analysis threads.\n");
+            exit(1);
+        }
+    }
+    async_worker_run(&pool.workers[0]);
+
+    for (size_t i = 1; i < pool.worker_count; ++i) {
+        pthread_join(pool.workers[i].thread, NULL);
     }
 
-    // Union of the results
-    Abstract_State *acc = wa->ops->union_(wa->ctx, states[0], states[0]);
-    Abstract_State *prev_acc = NULL;
-    for (size_t i = 1; i < node.preds_count; ++i) {
-        prev_acc = acc;
-        acc = wa->ops->union_(wa->ctx, acc, states[i]);
-        wa->ops->state_free(prev_acc);
+    // No more readers, all the retired states can be freed
+    for (size_t i = 0; i < pool.worker_count; ++i) {
+        Async_Worker *w = &pool.workers[i];
+        wa->iterations += w->iterations;
+
+        for (size_t j = 0; j < w->limbo_count; ++j) {
+            wa->ops->state_free(w->limbo[j].state);
+        }
+        for (size_t j = 0; j < w->free_count; ++j) {
+            wa->ops->state_free(w->free_states[j]);
+        }
+        free(w->limbo);
+        free(w->free_states);
+        wa->ops->exec_buf_free(w->exec_buf);
     }
 
-    // States free
-    for (size_t i = 0; i < node.preds_count; ++i) {
-        wa->ops->state_free(states[i]);
+    free(pool.workers);
+    free(pool.status);
+    free(pool.queue.cells);
+}
+
+/* /////////////////////////////////////////////////////////////////////////////////// */
+
+// Recursive iteration strategy over the WTO elements.
+//
+// A component is stabilized by iterating its head and then its body
+// (where the inner components are stabilized first), until the head state does not change.
+// The components being stabilized are kept on a stack, from the outermost one.
+static void exec_wto(While_Analyzer *wa, const While_Analyzer_Exec_Opt *opt, const WTO *wto, size_t *step_count) {
+    size_t *heads = xmalloc(sizeof(size_t) * wto->count);
+    size_t depth = 0;
+
+    size_t i = 0;
+    size_t end = wto->count;
+    for (;;) {
+        if (i == end) {
+            if (depth == 0) break;
+
+            // End of the body, iterate again the head of the innermost component
+            size_t head = heads[depth - 1];
+            size_t id = wto->order[head];
+            step_count[id]++;
+            bool changed = update_state(wa, id, step_count[id] > opt->widening_delay);
+            if (changed) {
+                i = head + 1;
+            } else {
+                depth--;
+                i = wto->component_end[head];
+                end = depth > 0 ? wto->component_end[heads[depth - 1]] : wto->count;
+            }
+            continue;
+        }
+
+        size_t id = wto->order[i];
+        if (wto->component_end[i] == 0) {
+            // P0 will not change
+            if (id != 0) {
+                step_count[id]++;
+                update_state(wa, id, false);
+            }
+            i++;
+        } else {
+            // First iteration of the head, the body is always executed after it
+            step_count[id]++;
+            update_state(wa, id, step_count[id] > opt->widening_delay);
+
+            heads[depth++] = i;
+            end = wto->component_end[i];
+            i++;
+        }
     }
-    free(states);
 
-    return acc;
+    free(heads);
 }
 
+// CFG simplification pass, fills 'point' with the new id of each node (see 'cfg_contract_skips')
+typedef CFG *(*CFG_Pass)(const CFG *cfg, size_t *point, Arena *arena);
+
+// Replace the analyzed CFG with its simplification by 'pass', updating the program points map
+static void simplify_cfg(While_Analyzer *wa, CFG_Pass pass) {
+    if (wa->point == NULL) {
+        wa->point = arena_alloc(&wa->arena, sizeof(size_t) * wa->program_cfg->count);
+        for (size_t i = 0; i < wa->program_cfg->count; ++i) {
+            wa->point[i] = i;
+        }
+    }
+
+    size_t *map = xmalloc(sizeof(size_t) * wa->cfg->count);
+    wa->cfg = pass(wa->cfg, map, &wa->arena);
+
+    for (size_t i = 0; i < wa->program_cfg->count; ++i) {
+        if (wa->point[i] != SIZE_MAX) {
+            wa->point[i] = map[wa->point[i]];
+        }
+    }
+    free(map);
+}
 
 // Default init for all types of domain
 While_Analyzer *while_analyzer_init(const char *src_path, const While_Analyzer_Opt *opt) {
 
     // Init analyzer
     While_Analyzer *wa = xmalloc(sizeof(While_Analyzer));
-    wa->src = read_file(src_path);
+    wa->src = source_open(src_path);
+    wa->arena = (Arena) {0};
+    wa->iterations = 0;
 
-    // Lexer
-    Lexer *lex = lex_init(wa->src);
+    // Lexer, the source is tokenized once and the tokens are used by all the collections below
+    Lexer *lex = lex_init(wa->src.text);
 
     // AST
-    AST_Node *ast = parser_parse(lex);
-    lex_free(lex);
+    AST_Node *ast = parser_parse(lex, &wa->arena);
+
+    // Collect variables in the source
+    wa->vars = (Variables) {0};
+    vars_collect(lex, &wa->vars);
 
     // Get CFG
-    wa->cfg = cfg_get(ast);
-    parser_free_ast_node(ast);
+    wa->program_cfg = cfg_get(ast, &wa->vars, &wa->arena);
+    wa->cfg = wa->program_cfg;
+    wa->point = NULL;
+
+    if (opt->contract_skips) {
+        simplify_cfg(wa, cfg_contract_skips);
+    }
+    if (opt->basic_blocks) {
+        simplify_cfg(wa, cfg_coalesce_blocks);
+    }
 
     // Domain specific init
     switch (opt->type) {
@@ -304,13 +1168,15 @@ While_Analyzer *while_analyzer_init(const char *src_path, const While_Analyzer_O
         {
             int64_t m = opt->as.parametric_interval.m;
             int64_t n = opt->as.parametric_interval.n;
-            while_analyzer_init_parametric_interval(wa, src_path, m, n);
+            while_analyzer_init_parametric_interval(wa, lex, m, n);
             break;
         }
     default:
         assert(0 && "UNREACHABLE");
     }
 
+    lex_free(lex);
+
     return wa;
 }
 
@@ -338,83 +1204,122 @@ void while_analyzer_exec(While_Analyzer *wa, const While_Analyzer_Exec_Opt *opt)
         wa->ops->state_set_bottom(wa->ctx, wa->state[i]);
     }
 
+    // Transfer cache, every state starts at version 1 so every edge is computed the first time
+    wa->edge_state = xcalloc(wa->cfg->edge_count, sizeof(Abstract_State *));
+    wa->edge_version = xcalloc(wa->cfg->edge_count, sizeof(size_t));
+    wa->version = xmalloc(sizeof(size_t) * wa->cfg->count);
+    for (size_t i = 0; i < wa->cfg->count; ++i) {
+        wa->version[i] = 1;
+    }
+
+    // Buffer for the new state of a program point, it is swapped with the old one when the state changes
+    wa->scratch = wa->ops->state_init(wa->ctx);
+    wa->exec_buf = wa->ops->exec_buf_init(wa->ctx);
+
     // Create a counter for each point (needed for opt->widening_delay)
     size_t *step_count = xcalloc(wa->cfg->count, sizeof(size_t));
+    wa->iterations = 0;
 
-    // === Worklist algorithm ===
-    Worklist wl = {0};
-    worklist_init(&wl);
-
-    // Add the second program point (P1) to the worklist.
-    // Skipping the first because it will not change.
-    worklist_enqueue(&wl, 1);
+    switch (opt->strategy) {
+    case WHILE_ANALYZER_STRATEGY_WORKLIST:
+        if (opt->threads > 1) {
+            exec_worklist_parallel(wa, opt, step_count);
+        } else {
+            exec_worklist(wa, opt, step_count);
+        }
+        break;
+    case WHILE_ANALYZER_STRATEGY_WTO:
+        {
+            WTO *wto = wto_get(wa->cfg);
+            exec_wto(wa, opt, wto, step_count);
+            wto_free(wto);
+            break;
+        }
+    case WHILE_ANALYZER_STRATEGY_ASYNC:
+        exec_async(wa, opt, step_count);
+        break;
+    default:
+        assert(0 && "UNREACHABLE");
+    }
 
-    while (wl.tail != NULL) {
-        size_t id = worklist_dequeue(&wl);
-        CFG_Node node = wa->cfg->nodes[id];
-        step_count[id]++;
+    free(step_count);
 
-        if (id != 0) {
-            // Union of the preds transfer functions
-            Abstract_State *transf_union = abstract_transfer_union(wa, id);
+    exec_narrowing(wa, opt);
 
-            // Apply widening if we are on a widening point
-            if (node.is_while && step_count[id] > opt->widening_delay) {
-                Abstract_State *prev_transf = transf_union;
-                transf_union = wa->ops->widening(wa->ctx, wa->state[id], transf_union);
-                wa->ops->state_free(prev_transf);
-            }
+    // Transfer cache free
+    for (size_t i = 0; i < wa->cfg->edge_count; ++i) {
+        if (wa->edge_state[i] != NULL) {
+            wa->ops->state_free(wa->edge_state[i]);
+        }
+    }
+    free(wa->edge_state);
+    free(wa->edge_version);
+    free(wa->version);
+    wa->ops->state_free(wa->scratch);
+    wa->ops->exec_buf_free(wa->exec_buf);
+}
 
-            // If state changed signal the node dependencies
-            bool state_changed = !(wa->ops->state_leq(wa->ctx, wa->state[id], transf_union) && wa->ops->state_leq(wa->ctx, transf_union, wa->state[id]));
-            if (state_changed) {
-                wa->ops->state_free(wa->state[id]);
-                wa->state[id] = transf_union;
+size_t while_analyzer_iterations(const While_Analyzer *wa) {
+    return wa->iterations;
+}
 
-                for (size_t i = 0; i < node.edge_count; ++i) {
-                    size_t dep = node.edges[i].dst;
-                    worklist_enqueue(&wl, dep);
-                }
-            } else {
-                wa->ops->state_free(transf_union);
-            }
+void while_analyzer_states_dump(const While_Analyzer *wa, FILE *fp) {
+    if (wa->point == NULL) {
+        for (size_t i = 0; i < wa->cfg->count; ++i) {
+            fprintf(fp, "[P%zu]\n", i);
+            wa->ops->state_print(wa->ctx, wa->state[i], fp);
         }
+        return;
     }
 
-    free(step_count);
-
-    // Apply narrowing
-    for (size_t i = 0; i < opt->descending_steps; ++i) {
-        for (size_t id = 0; id < wa->cfg->count; ++id) {
-            CFG_Node node = wa->cfg->nodes[id];
+    // The state of a removed point is the union of its incoming transfer functions.
+    // The points are computed in id order: the predecessors of a skip node or of a node
+    // inside a basic block come before it (the only back edges go to the loop heads, that are kept).
+    const CFG *cfg = wa->program_cfg;
+    Abstract_State **contracted = xcalloc(cfg->count, sizeof(Abstract_State *));
+    Abstract_State *transfer = wa->ops->state_init(wa->ctx);
+    Abstract_Exec_Buf *exec_buf = wa->ops->exec_buf_init(wa->ctx);
 
-            if (id != 0) {
-                Abstract_State *res = abstract_transfer_union(wa, id);
+    for (size_t i = 0; i < cfg->count; ++i) {
+        const Abstract_State *state = NULL;
 
-                // Apply narrowing only on widening points
-                if (node.is_while) {
-                    Abstract_State *transf_union = res;
-                    res = wa->ops->narrowing(wa->ctx, wa->state[id], transf_union);
-                    wa->ops->state_free(transf_union);
+        if (wa->point[i] != SIZE_MAX) {
+            state = wa->state[wa->point[i]];
+        } else {
+            contracted[i] = wa->ops->state_init(wa->ctx);
+
+            const CFG_Node *node = &cfg->nodes[i];
+            for (size_t j = 0; j < node->in_count; ++j) {
+                const CFG_Edge *edge = &cfg->edges[node->in_edges[j]];
+                assert(edge->src < i && "Removed point before its predecessor");
+
+                const Abstract_State *pred = wa->point[edge->src] != SIZE_MAX ? wa->state[wa->point[edge->src]] : contracted[edge->src];
+                if (j == 0) {
+                    wa->ops->exec_command_into(wa->ctx, contracted[i], pred, &edge->bytecode, exec_buf);
+                } else {
+                    wa->ops->exec_command_into(wa->ctx, transfer, pred, &edge->bytecode, exec_buf);
+                    wa->ops->union_into(wa->ctx, contracted[i], contracted[i], transfer);
                 }
-
-                // State update
-                wa->ops->state_free(wa->state[id]);
-                wa->state[id] = res;
             }
+            state = contracted[i];
         }
-    }
-}
 
-void while_analyzer_states_dump(const While_Analyzer *wa, FILE *fp) {
-    for (size_t i = 0; i < wa->cfg->count; ++i) {
         fprintf(fp, "[P%zu]\n", i);
-        wa->ops->state_print(wa->ctx, wa->state[i], fp);
+        wa->ops->state_print(wa->ctx, state, fp);
+    }
+
+    for (size_t i = 0; i < cfg->count; ++i) {
+        if (contracted[i] != NULL) {
+            wa->ops->state_free(contracted[i]);
+        }
     }
+    free(contracted);
+    wa->ops->state_free(transfer);
+    wa->ops->exec_buf_free(exec_buf);
 }
 
 void while_analyzer_cfg_dump(const While_Analyzer *wa, FILE *fp) {
-    cfg_print_graphviz(wa->cfg, fp);
+    cfg_print_graphviz(wa->program_cfg, fp);
 }
 
 void while_analyzer_free(While_Analyzer *wa) {
@@ -425,7 +1330,8 @@ void while_analyzer_free(While_Analyzer *wa) {
     }
     free(wa->state);
     wa->ops->ctx_free(wa->ctx);
-    free(wa->src);
-    cfg_free(wa->cfg);
+    vars_free(&wa->vars);
+    source_close(&wa->src);
+    arena_free(&wa->arena);
     free(wa);
 }
@@ -1,25 +1,41 @@
 #ifndef WHILE_AI_ABSTRACT_DOMAIN_
 #define WHILE_AI_ABSTRACT_DOMAIN_
 
-#include "lang/parser.h"
+#include "lang/bytecode.h"
 #include <stdio.h>
+#include <stdint.h>
 
 typedef void Abstract_State;
 typedef void Abstract_Dom_Ctx;
+typedef void Abstract_Exec_Buf;
 
 // Operations in the current abstract domain
 typedef struct {
     void (*ctx_free) (Abstract_Dom_Ctx *ctx);
+    Abstract_State *(*state_init) (const Abstract_Dom_Ctx *ctx);
     void (*state_free) (Abstract_State *s);
+    void (*state_copy) (const Abstract_Dom_Ctx *ctx, Abstract_State *dst, const Abstract_State *src);
     void (*state_set_bottom) (const Abstract_Dom_Ctx *ctx, Abstract_State *s);
     void (*state_set_top) (const Abstract_Dom_Ctx *ctx, Abstract_State *s);
     void (*state_set_from_config) (const Abstract_Dom_Ctx *ctx, Abstract_State *s, FILE *fp);
     void (*state_print) (const Abstract_Dom_Ctx *ctx, const Abstract_State *s, FILE *fp);
-    Abstract_State *(*exec_command) (const Abstract_Dom_Ctx *ctx, const Abstract_State *s, const AST_Node *command);
+    Abstract_State *(*exec_command) (const Abstract_Dom_Ctx *ctx, const Abstract_State *s, const Bytecode *command);
     bool (*state_leq) (const Abstract_Dom_Ctx *ctx, const Abstract_State *s1, const Abstract_State *s2);
+    bool (*state_equal) (const Abstract_Dom_Ctx *ctx, const Abstract_State *s1, const Abstract_State *s2);
+    uint64_t (*state_hash) (const Abstract_Dom_Ctx *ctx, const Abstract_State *s);
     Abstract_State *(*union_) (const Abstract_Dom_Ctx *ctx, const Abstract_State *s1, const Abstract_State *s2);
     Abstract_State *(*widening) (const Abstract_Dom_Ctx *ctx, const Abstract_State *s1, const Abstract_State *s2);
     Abstract_State *(*narrowing) (const Abstract_Dom_Ctx *ctx, const Abstract_State *s1, const Abstract_State *s2);
+
+    // Temporary memory of 'exec_command_into', reused by all the commands executed by a thread
+    Abstract_Exec_Buf *(*exec_buf_init) (const Abstract_Dom_Ctx *ctx);
+    void (*exec_buf_free) (Abstract_Exec_Buf *buf);
+
+    // Destination-passing variants: the result is written in 'dst', that can be the same state of an operand
+    void (*exec_command_into) (const Abstract_Dom_Ctx *ctx, Abstract_State *dst, const Abstract_State *s, const Bytecode *command, Abstract_Exec_Buf *buf);
+    void (*union_into) (const Abstract_Dom_Ctx *ctx, Abstract_State *dst, const Abstract_State *s1, const Abstract_State *s2);
+    void (*widening_into) (const Abstract_Dom_Ctx *ctx, Abstract_State *dst, const Abstract_State *s1, const Abstract_State *s2);
+    void (*narrowing_into) (const Abstract_Dom_Ctx *ctx, Abstract_State *dst, const Abstract_State *s1, const Abstract_State *s2);
 } Abstract_Dom_Ops;
 
 
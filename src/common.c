@@ -2,15 +2,55 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdbool.h>
 
-void vars_push_unique(Variables *vars, String s) {
-    // Check if s is already present in the array
+// FNV-1a hash of the string
+static uint64_t string_hash(String s) {
+    uint64_t h = 0xcbf29ce484222325;
+    for (size_t i = 0; i < s.len; ++i) {
+        h ^= (unsigned char)s.name[i];
+        h *= 0x100000001b3;
+    }
+    return h;
+}
+
+static bool string_equal(String s1, String s2) {
+    return s1.len == s2.len && memcmp(s1.name, s2.name, s1.len) == 0;
+}
+
+// Returns the table slot of 's', or the empty slot where it should be inserted
+static size_t vars_find_slot(const Variables *vars, String s) {
+    size_t mask = vars->table_capacity - 1;
+    size_t slot = string_hash(s) & mask;
+
+    while (vars->table[slot] != SIZE_MAX && !string_equal(vars->var[vars->table[slot]], s)) {
+        slot = (slot + 1) & mask;
+    }
+
+    return slot;
+}
+
+static void vars_table_grow(Variables *vars) {
+    free(vars->table);
+    vars->table_capacity = vars->table_capacity == 0 ? 64 : vars->table_capacity * 2;
+    vars->table = xmalloc(vars->table_capacity*sizeof(size_t));
+    memset(vars->table, 0xff, vars->table_capacity*sizeof(size_t));
+
+    // Re-insert the ids
     for (size_t i = 0; i < vars->count; ++i) {
-        if (s.len == vars->var[i].len) {
-            if (strncmp(vars->var[i].name, s.name, s.len) == 0) {
-                return;
-            }
-        }
+        vars->table[vars_find_slot(vars, vars->var[i])] = i;
+    }
+}
+
+size_t vars_intern(Variables *vars, String s) {
+    if ((vars->count + 1) * 2 > vars->table_capacity) {
+        vars_table_grow(vars);
+    }
+
+    // Check if s is already present in the table
+    size_t slot = vars_find_slot(vars, s);
+    if (vars->table[slot] != SIZE_MAX) {
+        return vars->table[slot];
     }
 
     if (vars->count >= vars->capacity) {
@@ -21,17 +61,25 @@ void vars_push_unique(Variables *vars, String s) {
         }
         vars->var = xrealloc(vars->var, vars->capacity*sizeof(String));
     }
+    vars->table[slot] = vars->count;
     vars->var[vars->count++] = s;
+
+    return vars->table[slot];
 }
 
-void constant_push_unique(Constants *c, int64_t constant) {
-    // Check if s is already present in the array
-    for (size_t i = 0; i < c->count; ++i) {
-        if (c->data[i] == constant) {
-            return;
-        }
+size_t vars_index_of(const Variables *vars, String s) {
+    if (vars->table_capacity == 0) {
+        return SIZE_MAX;
     }
+    return vars->table[vars_find_slot(vars, s)];
+}
+
+void vars_free(Variables *vars) {
+    free(vars->var);
+    free(vars->table);
+}
 
+void constant_push(Constants *c, int64_t constant) {
     if (c->count >= c->capacity) {
         if (c->capacity == 0) {
             c->capacity = 32; // Inits with 32 elements
@@ -43,6 +91,86 @@ void constant_push_unique(Constants *c, int64_t constant) {
     c->data[c->count++] = constant;
 }
 
+static int int64_compare(const void *a, const void *b) {
+    const int64_t *a_int = (const int64_t *) a;
+    const int64_t *b_int = (const int64_t *) b;
+
+    if (*b_int < *a_int) {
+        return 1;
+    } else if (*b_int > *a_int) {
+        return -1;
+    } else {
+        return 0;
+    }
+}
+
+void constants_sort_unique(Constants *c) {
+    if (c->count == 0) {
+        return;
+    }
+
+    qsort(c->data, c->count, sizeof(int64_t), int64_compare);
+
+    size_t unique = 1;
+    for (size_t i = 1; i < c->count; ++i) {
+        if (c->data[i] != c->data[unique - 1]) {
+            c->data[unique++] = c->data[i];
+        }
+    }
+    c->count = unique;
+}
+
+// Default size of the arena blocks, bigger allocations get a block of their size
+#define ARENA_BLOCK_SIZE (64*1024)
+
+// Alignment of the arena allocations
+#define ARENA_ALIGN 16
+
+struct Arena_Block {
+    Arena_Block *prev;
+    size_t used;
+    size_t capacity;
+    unsigned char data[];
+};
+
+void *arena_alloc(Arena *arena, size_t size) {
+    Arena_Block *block = arena->block;
+
+    // Padding for aligning the next allocation
+    size_t padding = 0;
+    if (block != NULL) {
+        uintptr_t next = (uintptr_t)(block->data + block->used);
+        padding = (ARENA_ALIGN - next % ARENA_ALIGN) % ARENA_ALIGN;
+    }
+
+    if (block == NULL || block->used + padding + size > block->capacity) {
+        // New block, with space for the alignment of the first allocation
+        size_t capacity = size + ARENA_ALIGN > ARENA_BLOCK_SIZE ? size + ARENA_ALIGN : ARENA_BLOCK_SIZE;
+        block = xcalloc(1, sizeof(Arena_Block) + capacity);
+        block->prev = arena->block;
+        block->used = 0;
+        block->capacity = capacity;
+        arena->block = block;
+
+        uintptr_t next = (uintptr_t)block->data;
+        padding = (ARENA_ALIGN - next % ARENA_ALIGN) % ARENA_ALIGN;
+    }
+
+    void *ptr = block->data + block->used + padding;
+    block->used += padding + size;
+    return ptr;
+}
+
+void arena_free(Arena *arena) {
+    Arena_Block *block = arena->block;
+    while (block != NULL) {
+        Arena_Block *prev = block->prev;
+        free(block);
+        block = prev;
+    }
+    arena->block = NULL;
+}
+
 void *xmalloc(size_t size) {
     void *ptr = malloc(size);
     if (ptr == NULL) {
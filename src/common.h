@@ -9,10 +9,16 @@ typedef struct {
     size_t len;
 } String;
 
+// Interning table of the program variables, every variable has a dense id (its index in 'var').
 typedef struct {
     String *var;
     size_t count;
     size_t capacity;
+
+    // Open addressing hash table (linear probing) of the ids in 'var', SIZE_MAX marks an empty slot.
+    // The capacity is a power of two and the table is kept at most half full.
+    size_t *table;
+    size_t table_capacity;
 } Variables;
 
 typedef struct {
@@ -21,11 +27,34 @@ typedef struct {
     size_t capacity;
 } Constants;
 
-// Push 's' into the array if not already inside
-void vars_push_unique(Variables *vars, String s);
+// Push 's' into the table if not already inside, returns its id
+size_t vars_intern(Variables *vars, String s);
+
+// Returns the id of 's', SIZE_MAX if not found
+size_t vars_index_of(const Variables *vars, String s);
+
+// Free the table
+void vars_free(Variables *vars);
+
+// Push 'constant' into the array (duplicates are removed by 'constants_sort_unique')
+void constant_push(Constants *c, int64_t constant);
+
+// Sort the array and remove the duplicates
+void constants_sort_unique(Constants *c);
+
+// Bump allocator: the memory is taken from big blocks and it is released all at once by 'arena_free'.
+// Used for the data that lives as long as the analyzer (AST, CFG and commands bytecode).
+typedef struct Arena_Block Arena_Block;
+
+typedef struct {
+    Arena_Block *block; // Current block, the previous ones are linked from it
+} Arena;
+
+// Returns 'size' bytes of zero initialized memory from the arena (aligned for any type)
+void *arena_alloc(Arena *arena, size_t size);
 
-// Push 'constant' into the array if not already inside
-void constant_push_unique(Constants *c, int64_t constant);
+// Free all the memory of the arena
+void arena_free(Arena *arena);
 
 // Same as originals but exits on OOM
 void *xmalloc(size_t size);
@@ -11,10 +11,28 @@ struct Abstract_Interval_Ctx {
     Variables vars;
     // Threshold points for widening, this array is sorted and contains always -INF and +INF
     Constants widening_points;
+    // The same points in Eytzinger order (1-based, the children of k are 2k and 2k+1),
+    // the first levels of the search tree share a few cache lines
+    int64_t *widening_index;
 };
 
 /* ================================== Interval ops ==================================== */
 
+// Returns the canonical Bottom interval
+static Interval interval_bottom(void) {
+    Interval i = {
+        .type = INTERVAL_BOTTOM,
+        .a = 0,
+        .b = 0,
+    };
+    return i;
+}
+
+// Check if the intervals 'i1' and 'i2' are equal (the encoding is canonical)
+static bool interval_equal(Interval i1, Interval i2) {
+    return i1.type == i2.type && i1.a == i2.a && i1.b == i2.b;
+}
+
 // Check if interval 'i1' is a less than or equal to interval 'i2'.
 // Returns true if i1 <= i2 (if i1 is contained in i2), false otherwise.
 static bool interval_leq(Interval i1, Interval i2) {
@@ -43,8 +61,7 @@ static Interval interval_create(const Abstract_Interval_Ctx *ctx, int64_t a, int
 
     // Empty interval (Bottom)
     if (a > b) {
-        i.type = INTERVAL_BOTTOM;
-        return i;
+        return interval_bottom();
     }
 
     // Top
@@ -352,7 +369,7 @@ static Interval interval_div(const Abstract_Interval_Ctx *ctx, Interval i1, Inte
         pos.a = i2.a >= pos.a ? i2.a : pos.a;
         pos.b = i2.b >= pos.b ? pos.b : i2.b;
         if (pos.a > pos.b) {
-            pos.type = INTERVAL_BOTTOM;
+            pos = interval_bottom();
         }
 
         // Intersect (-INF,-1] with i2
@@ -364,7 +381,7 @@ static Interval interval_div(const Abstract_Interval_Ctx *ctx, Interval i1, Inte
         neg.a = i2.a >= neg.a ? i2.a : neg.a;
         neg.b = i2.b >= neg.b ? neg.b : i2.b;
         if (neg.a > neg.b) {
-            neg.type = INTERVAL_BOTTOM;
+            neg = interval_bottom();
         }
 
         Interval positive_part = interval_div(ctx, i1, pos);
@@ -375,6 +392,50 @@ static Interval interval_div(const Abstract_Interval_Ctx *ctx, Interval i1, Inte
 }
 
 // Widening operator (using thresholds)
+// The searches descend the Eytzinger tree without branches, the path taken is recorded
+// in the bits of 'i' (a 1 for each step to the right). Both return 0 if there is no such point.
+
+// Returns the Eytzinger position of the first widening point >= 'v'
+static size_t widening_points_lower_bound(const Abstract_Interval_Ctx *ctx, int64_t v) {
+    const int64_t *e = ctx->widening_index;
+    size_t count = ctx->widening_points.count;
+    size_t i = 1;
+    while (i <= count) {
+        i = 2*i + (e[i] < v);
+    }
+    // The point is where the path turned left for the last time
+    while (i & 1) {
+        i >>= 1;
+    }
+    return i >> 1;
+}
+
+// Returns the Eytzinger position of the last widening point <= 'v'
+static size_t widening_points_last_leq(const Abstract_Interval_Ctx *ctx, int64_t v) {
+    const int64_t *e = ctx->widening_index;
+    size_t count = ctx->widening_points.count;
+    size_t i = 1;
+    while (i <= count) {
+        i = 2*i + (e[i] <= v);
+    }
+    // The point is where the path turned right for the last time
+    while ((i & 1) == 0) {
+        i >>= 1;
+    }
+    return i >> 1;
+}
+
+// Fill 'e' with the sorted 'data' by an in-order visit of the subtree rooted at 'k',
+// returns the index of the next element of 'data' to place
+static size_t widening_index_fill(int64_t *e, const int64_t *data, size_t count, size_t next, size_t k) {
+    if (k <= count) {
+        next = widening_index_fill(e, data, count, next, 2*k);
+        e[k] = data[next++];
+        next = widening_index_fill(e, data, count, next, 2*k + 1);
+    }
+    return next;
+}
+
 static Interval interval_widening(const Abstract_Interval_Ctx *ctx, Interval i1, Interval i2) {
 
     // Bottom handling
@@ -390,15 +451,17 @@ static Interval interval_widening(const Abstract_Interval_Ctx *ctx, Interval i1,
     int64_t x = INTERVAL_MIN_INF;
     int64_t y = INTERVAL_PLUS_INF;
 
+    // Both thresholds are found by a search on the Eytzinger index.
+    // The smallest (largest) point is not used for y (x), like -INF (+INF) it is not a proper bound.
+    const Constants *k = &ctx->widening_points;
+
     if (i1.a <= i2.a) {
         x = i1.a;
     }
     else {
-        for (size_t i = 0; i < ctx->widening_points.count; ++i) {
-            if (ctx->widening_points.data[i] > i2.a) {
-                x = ctx->widening_points.data[i-1];
-                break;
-            }
+        size_t i = widening_points_last_leq(ctx, i2.a);
+        if (i != 0 && ctx->widening_index[i] != k->data[k->count - 1]) {
+            x = ctx->widening_index[i];
         }
     }
 
@@ -406,11 +469,9 @@ static Interval interval_widening(const Abstract_Interval_Ctx *ctx, Interval i1,
         y = i1.b;
     }
     else {
-        for (int i = ctx->widening_points.count - 1; i >= 0; --i) {
-            if (ctx->widening_points.data[i] < i2.b) {
-                y = ctx->widening_points.data[i+1];
-                break;
-            }
+        size_t i = widening_points_lower_bound(ctx, i2.b);
+        if (i != 0 && ctx->widening_index[i] != k->data[0]) {
+            y = ctx->widening_index[i];
         }
     }
 
@@ -444,11 +505,26 @@ static Interval_Tuple interval_backward_minus(const Abstract_Interval_Ctx *ctx,
     return t;
 }
 
+// Check if 0 is in the interval 'i'
+static bool interval_has_zero(Interval i) {
+    return i.type == INTERVAL_STD && i.a <= 0 && 0 <= i.b;
+}
+
+// Returns the values of the factor 'x' such that 'x * d' can be in 'p'.
+// If both 'p' and 'd' contain 0 every 'x' is possible (x * 0 = 0), so 'x' is not refined:
+// 'p / d' would drop the 0 of 'd' and lose them.
+static Interval interval_backward_factor(const Abstract_Interval_Ctx *ctx, Interval x, Interval p, Interval d) {
+    if (interval_has_zero(p) && interval_has_zero(d)) {
+        return x;
+    }
+    return interval_intersect(ctx, x, interval_div(ctx, p, d));
+}
+
 static Interval_Tuple interval_backward_mult(const Abstract_Interval_Ctx *ctx, Interval x, Interval y, Interval r) {
     Interval_Tuple t = {0};
 
-    t.a = interval_intersect(ctx, x, interval_div(ctx, r, y));
-    t.b = interval_intersect(ctx, y, interval_div(ctx, r, x));
+    t.a = interval_backward_factor(ctx, x, r, y);
+    t.b = interval_backward_factor(ctx, y, r, x);
 
     return t;
 }
@@ -458,7 +534,13 @@ static Interval_Tuple interval_backward_div(const Abstract_Interval_Ctx *ctx, In
     Interval s = interval_plus(ctx, r, interval_create(ctx, -1, 1));
 
     t.a = interval_intersect(ctx, x, interval_mult(ctx, s, y));
-    t.b = interval_intersect(ctx, y, interval_union(ctx, interval_div(ctx, x, s), interval_create(ctx, 0, 0)));
+
+    // If the quotient can be 0 then every y with |y| > |x| is possible, so y is not refined
+    if (interval_has_zero(s)) {
+        t.b = y;
+    } else {
+        t.b = interval_intersect(ctx, y, interval_union(ctx, interval_div(ctx, x, s), interval_create(ctx, 0, 0)));
+    }
 
     return t;
 }
@@ -473,13 +555,15 @@ Abstract_Interval_Ctx *abstract_interval_ctx_init(int64_t m, int64_t n, Variable
     ctx->n = n;
     ctx->vars = vars;
     ctx->widening_points = c;
+    ctx->widening_index = xmalloc(sizeof(int64_t) * (c.count + 1));
+    widening_index_fill(ctx->widening_index, c.data, c.count, 0, 1);
 
     return ctx;
 }
 
 void abstract_interval_ctx_free(Abstract_Interval_Ctx *ctx) {
-    free(ctx->vars.var);
     free(ctx->widening_points.data);
+    free(ctx->widening_index);
     free(ctx);
 }
 
@@ -496,6 +580,12 @@ void abstract_interval_state_free(Interval *s) {
     free(s);
 }
 
+void abstract_interval_state_copy(const Abstract_Interval_Ctx *ctx, Interval *dst, const Interval *src) {
+    if (dst != src) {
+        memcpy(dst, src, sizeof(Interval) * ctx->vars.count);
+    }
+}
+
 void abstract_interval_state_set_bottom(const Abstract_Interval_Ctx *ctx, Interval *s) {
     // Since BOTTOM enum value = 0, all the intervals will be bottom
     memset(s, 0, sizeof(Interval) * ctx->vars.count);
@@ -524,17 +614,12 @@ void abstract_interval_state_set_from_config(const Abstract_Interval_Ctx *ctx, I
         }
 
         // Get the variable interval index
-        size_t var_index = 0;
-        bool found = false;
-        for (size_t i = 0; i < ctx->vars.count; ++i) {
-            if (var_len == ctx->vars.var[i].len) {
-                if (strncmp(line, ctx->vars.var[i].name, var_len) == 0) {
-                    var_index = i;
-                    found = true;
-                }
-            }
-        }
-        if (!found) continue;
+        String var = {
+            .name = line,
+            .len = var_len,
+        };
+        size_t var_index = vars_index_of(&ctx->vars, var);
+        if (var_index == SIZE_MAX) continue;
 
         // Parse the interval value
         const char *c = line + var_len;
@@ -563,7 +648,7 @@ void abstract_interval_state_set_from_config(const Abstract_Interval_Ctx *ctx, I
             // Check endline/EOF
             if (*c != '\n' && *c != '\0') continue;
 
-            s[var_index].type = INTERVAL_BOTTOM;
+            s[var_index] = interval_bottom();
         }
         // Interval [a,b]
         else {
@@ -646,251 +731,310 @@ void abstract_interval_state_print(const Abstract_Interval_Ctx *ctx, const Inter
 }
 
 bool abstract_interval_state_leq(const Abstract_Interval_Ctx *ctx, const Interval *s1, const Interval *s2) {
-    bool result = true;
-
     // s1 <= s2 if all elements of s1 are <= all elements of s2
     for (size_t i = 0; i < ctx->vars.count; ++i) {
-        result = result && interval_leq(s1[i], s2[i]);
+        if (!interval_leq(s1[i], s2[i])) {
+            return false;
+        }
     }
 
-    return result;
+    return true;
 }
 
-Interval *abstract_interval_state_union(const Abstract_Interval_Ctx *ctx, const Interval *s1, const Interval *s2) {
-    Interval *res = abstract_interval_state_init(ctx);
-
+bool abstract_interval_state_equal(const Abstract_Interval_Ctx *ctx, const Interval *s1, const Interval *s2) {
     for (size_t i = 0; i < ctx->vars.count; ++i) {
-        res[i] = interval_union(ctx, s1[i], s2[i]);
+        if (!interval_equal(s1[i], s2[i])) {
+            return false;
+        }
     }
 
-    return res;
+    return true;
 }
 
-Interval *abstract_interval_state_intersect(const Abstract_Interval_Ctx *ctx, const Interval *s1, const Interval *s2) {
-    Interval *res = abstract_interval_state_init(ctx);
+// Mix the 64 bit word 'v' into the hash 'h' (FNV-1a on words, with a final xorshift for the high bits)
+static uint64_t hash_mix(uint64_t h, uint64_t v) {
+    h ^= v;
+    h *= 0x100000001b3;
+    h ^= h >> 29;
+    return h;
+}
+
+uint64_t abstract_interval_state_hash(const Abstract_Interval_Ctx *ctx, const Interval *s) {
+    uint64_t h = 0xcbf29ce484222325;
 
     for (size_t i = 0; i < ctx->vars.count; ++i) {
-        res[i] = interval_intersect(ctx, s1[i], s2[i]);
+        h = hash_mix(h, (uint64_t)s[i].type);
+        h = hash_mix(h, (uint64_t)s[i].a);
+        h = hash_mix(h, (uint64_t)s[i].b);
     }
 
-    return res;
+    return h;
 }
 
-Interval *abstract_interval_state_widening(const Abstract_Interval_Ctx *ctx, const Interval *s1, const Interval *s2) {
+Interval *abstract_interval_state_union(const Abstract_Interval_Ctx *ctx, const Interval *s1, const Interval *s2) {
     Interval *res = abstract_interval_state_init(ctx);
-
-    for (size_t i = 0; i < ctx->vars.count; ++i) {
-        res[i] = interval_widening(ctx, s1[i], s2[i]);
-    }
-
+    abstract_interval_state_union_into(ctx, res, s1, s2);
     return res;
 }
 
-/* ================================ Commands execution ================================ */
-
-// Get the index for the variable 'var' (assuming that the variable exists)
-static size_t get_var(const Abstract_Interval_Ctx *ctx, String var) {
-    size_t var_index = 0;
-    for (size_t i = 0; i < ctx->vars.count; ++i) {
-        if (var.len == ctx->vars.var[i].len) {
-            if (strncmp(var.name, ctx->vars.var[i].name, var.len) == 0) {
-                var_index = i;
-            }
-        }
-    }
-    return var_index;
+Interval *abstract_interval_state_intersect(const Abstract_Interval_Ctx *ctx, const Interval *s1, const Interval *s2) {
+    Interval *res = abstract_interval_state_init(ctx);
+    abstract_interval_state_intersect_into(ctx, res, s1, s2);
+    return res;
 }
 
-// Returns a new heap allocated state with the same elements of 's'
-static Interval *clone_state(const Abstract_Interval_Ctx *ctx, const Interval *s) {
+Interval *abstract_interval_state_widening(const Abstract_Interval_Ctx *ctx, const Interval *s1, const Interval *s2) {
     Interval *res = abstract_interval_state_init(ctx);
-    memcpy(res, s, sizeof(Interval) * ctx->vars.count);
+    abstract_interval_state_widening_into(ctx, res, s1, s2);
     return res;
 }
 
-static Interval exec_aexpr(const Abstract_Interval_Ctx *ctx, const Interval *s, const AST_Node *node) {
-    switch (node->type) {
-    case NODE_NUM:
-        {
-            int64_t num = node->as.num;
-            return interval_create(ctx, num, num);
-        }
-    case NODE_VAR:
-        {
-            // Get the assigned variable
-            String var = node->as.var;
+void abstract_interval_state_union_into(const Abstract_Interval_Ctx *ctx, Interval *dst, const Interval *s1, const Interval *s2) {
+    for (size_t i = 0; i < ctx->vars.count; ++i) {
+        dst[i] = interval_union(ctx, s1[i], s2[i]);
+    }
+}
 
-            // Get the interval for that variable (here a variable must be found by contruction)
-            return s[get_var(ctx, var)];
-        }
-    case NODE_PLUS:
-        {
-            Interval i1 = exec_aexpr(ctx, s, node->as.child.left);
-            Interval i2 = exec_aexpr(ctx, s, node->as.child.right);
-            return interval_plus(ctx, i1, i2);
-        }
-    case NODE_MINUS:
-        {
-            Interval i1 = exec_aexpr(ctx, s, node->as.child.left);
-            Interval i2 = exec_aexpr(ctx, s, node->as.child.right);
-            return interval_minus(ctx, i1, i2);
-        }
-    case NODE_MULT:
-        {
-            Interval i1 = exec_aexpr(ctx, s, node->as.child.left);
-            Interval i2 = exec_aexpr(ctx, s, node->as.child.right);
-            return interval_mult(ctx, i1, i2);
-        }
-    case NODE_DIV:
-        {
-            Interval i1 = exec_aexpr(ctx, s, node->as.child.left);
-            Interval i2 = exec_aexpr(ctx, s, node->as.child.right);
-            return interval_div(ctx, i1, i2);
-        }
-    default:
-        assert(0 && "UNREACHABLE");
+void abstract_interval_state_intersect_into(const Abstract_Interval_Ctx *ctx, Interval *dst, const Interval *s1, const Interval *s2) {
+    for (size_t i = 0; i < ctx->vars.count; ++i) {
+        dst[i] = interval_intersect(ctx, s1[i], s2[i]);
     }
 }
 
-static void exec_bexp_backprop(const Abstract_Interval_Ctx *ctx, Interval *s, Interval r, const AST_Node *node) {
-    switch (node->type) {
-    case NODE_NUM:
-        {
-            // Nothing.
-            break;
-        }
-    case NODE_VAR:
-        {
-            // Update the refined variable
-            String var = node->as.var;
-            s[get_var(ctx, var)] = r;
-            break;
-        }
-    case NODE_PLUS:
-        {
-            // Get the value of the child aexp
-            Interval left_aexp = exec_aexpr(ctx, s, node->as.child.left);
-            Interval right_aexp = exec_aexpr(ctx, s, node->as.child.right);
+void abstract_interval_state_widening_into(const Abstract_Interval_Ctx *ctx, Interval *dst, const Interval *s1, const Interval *s2) {
+    for (size_t i = 0; i < ctx->vars.count; ++i) {
+        dst[i] = interval_widening(ctx, s1[i], s2[i]);
+    }
+}
 
-            // We must have [a,b] + right_aexp = r
-            // and          left_aexp + [c,d]  = r
-            //
-            // t.a = [a,b] and t.b = [c,d]
-            Interval_Tuple t = interval_backward_plus(ctx, left_aexp, right_aexp, r);
+/* ================================ Commands execution ================================ */
 
-            // Then we intersect [a,b] with left_aexp and [c,d] with right_aexp
-            left_aexp = interval_intersect(ctx, left_aexp, t.a);
-            right_aexp = interval_intersect(ctx, right_aexp, t.b);
+Interval_Exec_Buf *abstract_interval_exec_buf_init(const Abstract_Interval_Ctx *ctx) {
+    (void) ctx;
+    Interval_Exec_Buf *buf = xmalloc(sizeof(Interval_Exec_Buf));
+    *buf = (Interval_Exec_Buf) {0};
+    return buf;
+}
 
-            // Recursive call
-            exec_bexp_backprop(ctx, s, left_aexp, node->as.child.left);
-            exec_bexp_backprop(ctx, s, right_aexp, node->as.child.right);
+void abstract_interval_exec_buf_free(Interval_Exec_Buf *buf) {
+    free(buf->states);
+    free(buf->values);
+    free(buf);
+}
 
-            break;
-        }
-    case NODE_MINUS:
-        {
-            Interval left_aexp = exec_aexpr(ctx, s, node->as.child.left);
-            Interval right_aexp = exec_aexpr(ctx, s, node->as.child.right);
+// Grow the buffer for executing 'bc', it is reallocated only for a command bigger than all the previous ones
+static void exec_buf_reserve(const Abstract_Interval_Ctx *ctx, Interval_Exec_Buf *buf, const Bytecode *bc) {
+    // A comparison needs two values for each instruction (forward and refined), an Aexp at most one
+    if (2*bc->count > buf->value_capacity) {
+        buf->value_capacity = 2*bc->count;
+        buf->values = xrealloc(buf->values, buf->value_capacity*sizeof(Interval));
+    }
 
-            Interval_Tuple t = interval_backward_minus(ctx, left_aexp, right_aexp, r);
+    if (bc->state_depth * ctx->vars.count > buf->state_capacity) {
+        buf->state_capacity = bc->state_depth * ctx->vars.count;
+        buf->states = xrealloc(buf->states, buf->state_capacity*sizeof(Interval));
+    }
+}
 
-            left_aexp = interval_intersect(ctx, left_aexp, t.a);
-            right_aexp = interval_intersect(ctx, right_aexp, t.b);
+// Evaluate the Aexp rooted at the instruction 'root', 'stack' has room for one interval
+// for each instruction of the Aexp (the buffer values)
+static Interval exec_aexpr(const Abstract_Interval_Ctx *ctx, const Interval *s, const Bytecode *bc, size_t root, Interval *stack) {
+    size_t top = 0;
 
-            exec_bexp_backprop(ctx, s, left_aexp, node->as.child.left);
-            exec_bexp_backprop(ctx, s, right_aexp, node->as.child.right);
+    for (size_t i = bc->code[root].start; i <= root; ++i) {
+        const Bytecode_Instr *instr = &bc->code[i];
 
+        switch (instr->op) {
+        case BC_NUM:
+            stack[top++] = interval_create(ctx, instr->as.num, instr->as.num);
+            break;
+        case BC_VAR:
+            // The slot is resolved when the CFG is built
+            stack[top++] = s[instr->as.slot];
+            break;
+        case BC_PLUS:
+            top--;
+            stack[top-1] = interval_plus(ctx, stack[top-1], stack[top]);
+            break;
+        case BC_MINUS:
+            top--;
+            stack[top-1] = interval_minus(ctx, stack[top-1], stack[top]);
             break;
+        case BC_MULT:
+            top--;
+            stack[top-1] = interval_mult(ctx, stack[top-1], stack[top]);
+            break;
+        case BC_DIV:
+            top--;
+            stack[top-1] = interval_div(ctx, stack[top-1], stack[top]);
+            break;
+        default:
+            assert(0 && "UNREACHABLE");
         }
-    case NODE_MULT:
-        {
-            Interval left_aexp = exec_aexpr(ctx, s, node->as.child.left);
-            Interval right_aexp = exec_aexpr(ctx, s, node->as.child.right);
-
-            Interval_Tuple t = interval_backward_mult(ctx, left_aexp, right_aexp, r);
+    }
 
-            left_aexp = interval_intersect(ctx, left_aexp, t.a);
-            right_aexp = interval_intersect(ctx, right_aexp, t.b);
+    // A well formed Aexp leaves only its value on the stack
+    assert(top == 1);
+    return stack[top - 1];
+}
 
-            exec_bexp_backprop(ctx, s, left_aexp, node->as.child.left);
-            exec_bexp_backprop(ctx, s, right_aexp, node->as.child.right);
+// Forward pass of the HC4-revise algorithm: evaluate the instructions in [first, last] (only Aexp),
+// storing the value of the instruction i in 'val[i - first]'.
+static void exec_aexpr_forward(const Abstract_Interval_Ctx *ctx, const Interval *s, const Bytecode *bc, size_t first, size_t last, Interval *val) {
+    for (size_t i = first; i <= last; ++i) {
+        const Bytecode_Instr *instr = &bc->code[i];
+
+        // Values of the operands (the right one is the previous instruction)
+        Interval left = {0};
+        Interval right = {0};
+        if (instr->op != BC_NUM && instr->op != BC_VAR) {
+            left = val[instr->left - first];
+            right = val[i - 1 - first];
+        }
 
+        switch (instr->op) {
+        case BC_NUM:
+            val[i - first] = interval_create(ctx, instr->as.num, instr->as.num);
+            break;
+        case BC_VAR:
+            val[i - first] = s[instr->as.slot];
+            break;
+        case BC_PLUS:
+            val[i - first] = interval_plus(ctx, left, right);
+            break;
+        case BC_MINUS:
+            val[i - first] = interval_minus(ctx, left, right);
+            break;
+        case BC_MULT:
+            val[i - first] = interval_mult(ctx, left, right);
             break;
+        case BC_DIV:
+            val[i - first] = interval_div(ctx, left, right);
+            break;
+        default:
+            assert(0 && "UNREACHABLE");
         }
-    case NODE_DIV:
-        {
-            Interval left_aexp = exec_aexpr(ctx, s, node->as.child.left);
-            Interval right_aexp = exec_aexpr(ctx, s, node->as.child.right);
-
-            Interval_Tuple t = interval_backward_div(ctx, left_aexp, right_aexp, r);
+    }
+}
 
-            left_aexp = interval_intersect(ctx, left_aexp, t.a);
-            right_aexp = interval_intersect(ctx, right_aexp, t.b);
+// Backward pass of the HC4-revise algorithm: refine the variables of the instructions in [first, last],
+// where 'val' contains the values of the forward pass and 'r' the wanted values of the roots.
+//
+// The instructions are visited in reverse order, so the wanted value of an instruction
+// is always set by its parent before the instruction is visited.
+// A variable can appear more times in the expression, so it is intersected with every refinement.
+static void exec_bexp_backprop(const Abstract_Interval_Ctx *ctx, Interval *s, const Bytecode *bc, size_t first, size_t last, const Interval *val, Interval *r) {
+    for (size_t i = last + 1; i-- > first;) {
+        const Bytecode_Instr *instr = &bc->code[i];
+
+        if (instr->op == BC_NUM) {
+            // Nothing.
+            continue;
+        }
+        if (instr->op == BC_VAR) {
+            // Update the refined variable
+            s[instr->as.slot] = interval_intersect(ctx, s[instr->as.slot], r[i - first]);
+            continue;
+        }
 
-            exec_bexp_backprop(ctx, s, left_aexp, node->as.child.left);
-            exec_bexp_backprop(ctx, s, right_aexp, node->as.child.right);
+        // Values of the child aexp
+        size_t left = instr->left - first;
+        size_t right = i - 1 - first;
 
+        // We must have [a,b] op val[right] = r
+        // and          val[left] op [c,d]  = r
+        //
+        // t.a = [a,b] and t.b = [c,d]
+        Interval_Tuple t = {0};
+        switch (instr->op) {
+        case BC_PLUS:
+            t = interval_backward_plus(ctx, val[left], val[right], r[i - first]);
+            break;
+        case BC_MINUS:
+            t = interval_backward_minus(ctx, val[left], val[right], r[i - first]);
+            break;
+        case BC_MULT:
+            t = interval_backward_mult(ctx, val[left], val[right], r[i - first]);
             break;
+        case BC_DIV:
+            t = interval_backward_div(ctx, val[left], val[right], r[i - first]);
+            break;
+        default:
+            assert(0 && "UNREACHABLE");
         }
-    default:
-        assert(0 && "UNREACHABLE");
+
+        // Then we intersect [a,b] with the left value and [c,d] with the right one
+        r[left] = interval_intersect(ctx, val[left], t.a);
+        r[right] = interval_intersect(ctx, val[right], t.b);
     }
 }
 
-// Exec the Bexp following the Advanced Abstract Tests method proposed in the Minè Tutorial (4.6)
-static Interval *abstract_interval_state_exec_bexp(const Abstract_Interval_Ctx *ctx, const Interval *s, const AST_Node *node) {
-    switch (node->type) {
-    case NODE_BOOL_LITERAL:
+// Exec the literal or comparison at the instruction 'root' following the Advanced Abstract Tests method
+// proposed in the Minè Tutorial (4.6). The result is written in 'dst' (that can be equal to 's').
+// 'values' has room for two intervals for each instruction of the comparison.
+static void abstract_interval_state_exec_test(const Abstract_Interval_Ctx *ctx, Interval *dst, const Interval *s, const Bytecode *bc, size_t root, Interval *values) {
+    const Bytecode_Instr *instr = &bc->code[root];
+
+    switch (instr->op) {
+    case BC_BOOL:
         {
-            bool value = node->as.boolean;
+            bool value = instr->as.boolean;
             if (value) {
                 // No filtering
-                return clone_state(ctx, s);
+                abstract_interval_state_copy(ctx, dst, s);
             } else {
                 // Always false, so return bottom
-                Interval *res = abstract_interval_state_init(ctx);
-                abstract_interval_state_set_bottom(ctx, res);
-                return res;
+                abstract_interval_state_set_bottom(ctx, dst);
             }
+            break;
         }
-    case NODE_LEQ:
-    case NODE_EQ:
-    case NODE_NEQ:
-    case NODE_GT:
+    case BC_LEQ:
+    case BC_EQ:
+    case BC_NEQ:
+    case BC_GT:
         {
+            // Buffers of the forward values and of the refined values of the sub-expressions
+            size_t first = instr->start;
+            size_t last = root - 1;
+            size_t count = last - first + 1;
+
+            Interval *val = values;
+            Interval *r = values + count;
+
             // Forward propagration
-            Interval a1 = exec_aexpr(ctx, s, node->as.child.left);
-            Interval a2 = exec_aexpr(ctx, s, node->as.child.right);
+            exec_aexpr_forward(ctx, s, bc, first, last, val);
+            Interval a1 = val[instr->left - first];
+            Interval a2 = val[last - first];
 
             // Do 'a1 - a2' for testing against 'a1 - a2 op 0'
             Interval sub = interval_minus(ctx, a1, a2);
 
-            // Select the right interval to intersect based on the node type
+            // Select the right interval to intersect based on the operator
+            enum Bytecode_Op op = instr->op;
             Interval test_value = {0};
 
-            if (node->type == NODE_LEQ) {
+            if (op == BC_LEQ) {
                 // (-INF,0]
                 test_value = (Interval) {
                     .type = INTERVAL_STD,
                     .a = INTERVAL_MIN_INF,
                     .b = 0,
                 };
-            } else if (node->type == NODE_EQ) {
+            } else if (op == BC_EQ) {
                 // [0,0]
                 test_value = (Interval) {
                     .type = INTERVAL_STD,
                     .a = 0,
                     .b = 0,
                 };
-            } else if (node->type == NODE_NEQ) {
+            } else if (op == BC_NEQ) {
                 // TOP
                 test_value = (Interval) {
                     .type = INTERVAL_STD,
                     .a = INTERVAL_MIN_INF,
                     .b = INTERVAL_PLUS_INF,
                 };
-            } else if (node->type == NODE_GT) {
+            } else if (op == BC_GT) {
                 // [1, +INF)
                 test_value = (Interval) {
                     .type = INTERVAL_STD,
@@ -899,167 +1043,118 @@ static Interval *abstract_interval_state_exec_bexp(const Abstract_Interval_Ctx *
                 };
             }
 
-            Interval root = interval_intersect(ctx, sub, test_value);
+            Interval root_value = interval_intersect(ctx, sub, test_value);
 
             // Refine a1 and a2
-            Interval_Tuple t = interval_backward_minus(ctx, a1, a2, root);
+            Interval_Tuple t = interval_backward_minus(ctx, a1, a2, root_value);
             a1 = t.a;
             a2 = t.b;
 
             // Backward propagation
-            Interval *new_s = clone_state(ctx, s);
-            exec_bexp_backprop(ctx, new_s, a1, node->as.child.left);
-            exec_bexp_backprop(ctx, new_s, a2, node->as.child.right);
-
-            return new_s;
-        }
-    case NODE_NOT:
-        {
-            // Transform the AST in order to eliminate the not expr
-            AST_Node *root = parser_copy_node(node->as.child.left);
-
-            switch (root->type) {
-            case NODE_BOOL_LITERAL:
-                root->as.boolean = !(root->as.boolean);
-                break;
-            case NODE_EQ:
-                root->type = NODE_NEQ;
-                break;
-            case NODE_LEQ:
-                root->type = NODE_GT;
-                break;
-            case NODE_NEQ:
-                root->type = NODE_EQ;
-                break;
-            case NODE_GT:
-                root->type = NODE_LEQ;
-                break;
-            case NODE_NOT:
-                {
-                    AST_Node *new_root = root->as.child.left;
-                    free(root);
-                    root = new_root;
-                    break;
-                }
-            case NODE_AND:
-                {
-                    // Transform into !b1 OR !b2
-                    root->type = NODE_OR;
-
-                    AST_Node *left = create_node(NODE_NOT);
-                    left->as.child.left = root->as.child.left;
-
-                    AST_Node *right = create_node(NODE_NOT);
-                    right->as.child.left = root->as.child.right;
-
-                    root->as.child.left = left;
-                    root->as.child.right = right;
-                    break;
-                }
-            case NODE_OR:
-                {
-                    // Transform into !b1 AND !b2
-                    root->type = NODE_AND;
-
-                    AST_Node *left = create_node(NODE_NOT);
-                    left->as.child.left = root->as.child.left;
-
-                    AST_Node *right = create_node(NODE_NOT);
-                    right->as.child.left = root->as.child.right;
-
-                    root->as.child.left = left;
-                    root->as.child.right = right;
-                    break;
-                }
-            default:
-                assert(0 && "UNREACHABLE");
-            }
-
-            Interval *res = abstract_interval_state_exec_bexp(ctx, s, root);
-            parser_free_ast_node(root);
-            return res;
-        }
-    case NODE_AND:
-        {
-            // Exec the two bexp and do the intersection
-            Interval *s1 = abstract_interval_state_exec_bexp(ctx, s, node->as.child.left);
-            Interval *s2 = abstract_interval_state_exec_bexp(ctx, s, node->as.child.right);
-
-            Interval *res = abstract_interval_state_intersect(ctx, s1, s2);
-
-            free(s1);
-            free(s2);
-
-            return res;
-        }
-    case NODE_OR:
-        {
-            // Exec the two bexp and do the intersection
-            Interval *s1 = abstract_interval_state_exec_bexp(ctx, s, node->as.child.left);
-            Interval *s2 = abstract_interval_state_exec_bexp(ctx, s, node->as.child.right);
-
-            Interval *res = abstract_interval_state_union(ctx, s1, s2);
-
-            free(s1);
-            free(s2);
-
-            return res;
+            r[instr->left - first] = a1;
+            r[last - first] = a2;
+            abstract_interval_state_copy(ctx, dst, s);
+            exec_bexp_backprop(ctx, dst, bc, first, last, val, r);
+            break;
         }
     default:
         assert(0 && "UNREACHABLE");
     }
 }
 
-static Interval *abstract_interval_state_exec_assign(const Abstract_Interval_Ctx *ctx, const Interval *s, const AST_Node *assign) {
-
-    // Get the assigned variable
-    String var = assign->as.child.left->as.var;
+// Exec the Bexp rooted at the instruction 'root', the result is written in 'dst' (that can be equal to 's').
+//
+// The Bexp is in Negation Normal Form (see bytecode.h), so the negations are already
+// pushed down to the comparisons and literals.
+// The '&' and '|' are evaluated in postfix order on a stack of states: every test filters 's'
+// and then '&' intersects (and '|' joins) the two states on the top.
+static void abstract_interval_state_exec_bexp(const Abstract_Interval_Ctx *ctx, Interval *dst, const Interval *s, const Bytecode *bc, size_t root, Interval_Exec_Buf *buf) {
+    if (bc->code[root].op != BC_AND && bc->code[root].op != BC_OR) {
+        abstract_interval_state_exec_test(ctx, dst, s, bc, root, buf->values);
+        return;
+    }
 
-    // Get the interval for that variable
-    size_t var_index = 0;
-    for (size_t i = 0; i < ctx->vars.count; ++i) {
-        if (strncmp(var.name, ctx->vars.var[i].name, var.len) == 0) {
-            var_index = i;
+    // The stack of states is in the buffer, the state k starts at 'buf->states + k*vars.count'
+    size_t first = bc->code[root].start;
+    size_t n = ctx->vars.count;
+    Interval *stack = buf->states;
+    size_t count = 0;
+
+    for (size_t i = first; i <= root; ++i) {
+        switch (bc->code[i].op) {
+        case BC_BOOL:
+        case BC_EQ:
+        case BC_LEQ:
+        case BC_NEQ:
+        case BC_GT:
+            abstract_interval_state_exec_test(ctx, stack + count*n, s, bc, i, buf->values);
+            count++;
+            break;
+        case BC_AND:
+            count--;
+            abstract_interval_state_intersect_into(ctx, stack + (count - 1)*n, stack + (count - 1)*n, stack + count*n);
+            break;
+        case BC_OR:
+            count--;
+            abstract_interval_state_union_into(ctx, stack + (count - 1)*n, stack + (count - 1)*n, stack + count*n);
+            break;
+        default:
+            // Aexp, evaluated by its comparison
+            break;
         }
     }
 
-    // Compute the right expression of assign node
-    Interval aexpr_res = exec_aexpr(ctx, s, assign->as.child.right);
+    abstract_interval_state_copy(ctx, dst, stack);
+}
 
-    // Create the new state and return
-    Interval *res = clone_state(ctx, s);
+// Exec the assignments of the bytecode in order (more than one for a basic block),
+// updating in place the copy of 's' in 'dst'
+static void abstract_interval_state_exec_assign(const Abstract_Interval_Ctx *ctx, Interval *dst, const Interval *s, const Bytecode *bc, Interval_Exec_Buf *buf) {
+    abstract_interval_state_copy(ctx, dst, s);
+
+    for (size_t assign = 0; assign < bc->count; ++assign) {
+        if (bc->code[assign].op != BC_ASSIGN) {
+            continue;
+        }
 
-    // Update only if it is not Bottom
-    if (res[var_index].type != INTERVAL_BOTTOM) {
-        res[var_index] = aexpr_res;
+        // Get the assigned variable index, the right expression is just before the assign
+        size_t var_index = bc->code[assign].as.slot;
+
+        // Compute the right expression of assign node
+        Interval aexpr_res = exec_aexpr(ctx, dst, bc, assign - 1, buf->values);
+
+        // Update only if it is not Bottom
+        if (dst[var_index].type != INTERVAL_BOTTOM) {
+            dst[var_index] = aexpr_res;
+        }
     }
+}
 
+Interval *abstract_interval_state_exec_command(const Abstract_Interval_Ctx *ctx, const Interval *s, const Bytecode *command) {
+    Interval *res = abstract_interval_state_init(ctx);
+    Interval_Exec_Buf *buf = abstract_interval_exec_buf_init(ctx);
+    abstract_interval_state_exec_command_into(ctx, res, s, command, buf);
+    abstract_interval_exec_buf_free(buf);
     return res;
 }
 
-Interval *abstract_interval_state_exec_command(const Abstract_Interval_Ctx *ctx, const Interval *s, const AST_Node *command) {
+void abstract_interval_state_exec_command_into(const Abstract_Interval_Ctx *ctx, Interval *dst, const Interval *s, const Bytecode *command, Interval_Exec_Buf *buf) {
+    // The root of the command is the last instruction
+    size_t root = command->count - 1;
 
-    Interval *res = NULL;
+    exec_buf_reserve(ctx, buf, command);
 
-    switch (command->type) {
-    case NODE_ASSIGN:
-        res = abstract_interval_state_exec_assign(ctx, s, command);
+    switch (command->code[root].op) {
+    case BC_ASSIGN:
+        abstract_interval_state_exec_assign(ctx, dst, s, command, buf);
         break;
-    case NODE_BOOL_LITERAL:
-    case NODE_EQ:
-    case NODE_LEQ:
-    case NODE_NOT:
-    case NODE_AND:
-        res = abstract_interval_state_exec_bexp(ctx, s, command);
-        break;
-    case NODE_SKIP:
-        res = clone_state(ctx, s);
+    case BC_SKIP:
+        abstract_interval_state_copy(ctx, dst, s);
         break;
     default:
-        assert(0 && "UNREACHABLE");
+        abstract_interval_state_exec_bexp(ctx, dst, s, command, root, buf);
+        break;
     }
-
-    return res;
 }
 
 /* //////////////////////////////////////////////////////////////////////////////////// */
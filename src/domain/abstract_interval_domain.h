@@ -1,7 +1,7 @@
 #ifndef WHILE_AI_ABSTRACT_INTERVAL_DOM_
 #define WHILE_AI_ABSTRACT_INTERVAL_DOM_
 
-#include "../lang/parser.h"
+#include "../lang/bytecode.h"
 #include "../common.h"
 #include <stdio.h>
 
@@ -17,6 +17,9 @@ enum Interval_Type {
 // If a or b are INF, then their value is:
 //     INTERVAL_PLUS_INF for represent infinite.
 //     INTERVAL_MIN_INF for represent -infinite.
+//
+// The encoding is canonical: Bottom has always a = b = 0,
+// so two intervals are equal if and only if all their fields are equal.
 typedef struct {
     enum Interval_Type type;
     int64_t a;
@@ -27,7 +30,8 @@ typedef struct Abstract_Interval_Ctx Abstract_Interval_Ctx;
 
 // Return the domain context, setting parameters for Int(m,n) and the variables of the program.
 //
-// [NOTE]: The ownership of 'vars' and 'c' arrays are transfered to the ctx.
+// [NOTE]: The ownership of the 'c' array is transfered to the ctx,
+//         while the 'vars' array is only borrowed (it must outlive the ctx).
 Abstract_Interval_Ctx *abstract_interval_ctx_init(int64_t m, int64_t n, Variables vars, Constants c);
 
 // Free the context
@@ -53,6 +57,9 @@ Interval *abstract_interval_state_init(const Abstract_Interval_Ctx *ctx);
 // Free the abstract state
 void abstract_interval_state_free(Interval *s);
 
+// Copy the intervals of 'src' into 'dst'
+void abstract_interval_state_copy(const Abstract_Interval_Ctx *ctx, Interval *dst, const Interval *src);
+
 // Helper functions to set all the intervals of a state to bottom or top
 void abstract_interval_state_set_bottom(const Abstract_Interval_Ctx *ctx, Interval *s);
 void abstract_interval_state_set_top(const Abstract_Interval_Ctx *ctx, Interval *s);
@@ -75,12 +82,32 @@ void abstract_interval_state_set_from_config(const Abstract_Interval_Ctx *ctx, I
 // Prints the state intervals (plain text) to fp
 void abstract_interval_state_print(const Abstract_Interval_Ctx *ctx, const Interval *s, FILE *fp);
 
-// Abstract commands
-Interval *abstract_interval_state_exec_command(const Abstract_Interval_Ctx *ctx, const Interval *s, const AST_Node *command);
+// Temporary memory of the commands execution: the values of the sub-expressions and the stack of states
+// of the '&' and '|'. It grows to the biggest command executed and then it is reused,
+// so the execution does not allocate once the analysis is in its steady state.
+typedef struct {
+    Interval *states;
+    size_t state_capacity;
+    Interval *values;
+    size_t value_capacity;
+} Interval_Exec_Buf;
+
+Interval_Exec_Buf *abstract_interval_exec_buf_init(const Abstract_Interval_Ctx *ctx);
+void abstract_interval_exec_buf_free(Interval_Exec_Buf *buf);
+
+// Abstract commands, 'buf' can be used by one thread at a time
+Interval *abstract_interval_state_exec_command(const Abstract_Interval_Ctx *ctx, const Interval *s, const Bytecode *command);
+void abstract_interval_state_exec_command_into(const Abstract_Interval_Ctx *ctx, Interval *dst, const Interval *s, const Bytecode *command, Interval_Exec_Buf *buf);
 
 // Compare function, returns true if state 's1' <= 's2'
 bool abstract_interval_state_leq(const Abstract_Interval_Ctx *ctx, const Interval *s1, const Interval *s2);
 
+// Returns true if the states 's1' and 's2' are equal
+bool abstract_interval_state_equal(const Abstract_Interval_Ctx *ctx, const Interval *s1, const Interval *s2);
+
+// Hash of the state, equal states have the same hash
+uint64_t abstract_interval_state_hash(const Abstract_Interval_Ctx *ctx, const Interval *s);
+
 // Union
 Interval *abstract_interval_state_union(const Abstract_Interval_Ctx *ctx, const Interval *s1, const Interval *s2);
 
@@ -90,4 +117,11 @@ Interval *abstract_interval_state_intersect(const Abstract_Interval_Ctx *ctx, co
 // Widening
 Interval *abstract_interval_state_widening(const Abstract_Interval_Ctx *ctx, const Interval *s1, const Interval *s2);
 
+// Destination-passing variants of the operations above, the result is written in 'dst'.
+// 'dst' can be the same state of 's1' or 's2' ('s' for the commands), no memory is allocated
+// (the commands only grow their 'buf' the first time they need more room).
+void abstract_interval_state_union_into(const Abstract_Interval_Ctx *ctx, Interval *dst, const Interval *s1, const Interval *s2);
+void abstract_interval_state_intersect_into(const Abstract_Interval_Ctx *ctx, Interval *dst, const Interval *s1, const Interval *s2);
+void abstract_interval_state_widening_into(const Abstract_Interval_Ctx *ctx, Interval *dst, const Interval *s1, const Interval *s2);
+
 #endif  // WHILE_AI_ABSTRACT_INTERVAL_DOM_
@@ -1,6 +1,14 @@
 #include "abstract_interval_domain_wrap.h"
 #include "../abstract_interval_domain.h"
 
+static inline Abstract_State *abstract_interval_state_init_wrapper(const Abstract_Dom_Ctx *ctx) {
+    return (Abstract_State *) abstract_interval_state_init((const Abstract_Interval_Ctx *) ctx);
+}
+
+static inline void abstract_interval_state_copy_wrapper(const Abstract_Dom_Ctx *ctx, Abstract_State *dst, const Abstract_State *src) {
+    abstract_interval_state_copy((const Abstract_Interval_Ctx *) ctx, (Interval *) dst, (const Interval *) src);
+}
+
 static inline void abstract_interval_state_free_wrapper(Abstract_State *s) {
     abstract_interval_state_free((Interval *) s);
 }
@@ -25,7 +33,7 @@ static inline void abstract_interval_state_print_wrapper(const Abstract_Dom_Ctx
     abstract_interval_state_print((const Abstract_Interval_Ctx *) ctx, (const Interval *) s, fp);
 }
 
-static inline Abstract_State *abstract_interval_state_exec_command_wrapper(const Abstract_Dom_Ctx *ctx, const Abstract_State *s, const AST_Node *command) {
+static inline Abstract_State *abstract_interval_state_exec_command_wrapper(const Abstract_Dom_Ctx *ctx, const Abstract_State *s, const Bytecode *command) {
     return (Abstract_State *) abstract_interval_state_exec_command((const Abstract_Interval_Ctx *) ctx, (const Interval *) s, command);
 }
 
@@ -33,6 +41,14 @@ static inline bool abstract_interval_state_leq_wrapper(const Abstract_Dom_Ctx *c
     return abstract_interval_state_leq((const Abstract_Interval_Ctx *) ctx, (const Interval *) s1, (const Interval *) s2);
 }
 
+static inline bool abstract_interval_state_equal_wrapper(const Abstract_Dom_Ctx *ctx, const Abstract_State *s1, const Abstract_State *s2) {
+    return abstract_interval_state_equal((const Abstract_Interval_Ctx *) ctx, (const Interval *) s1, (const Interval *) s2);
+}
+
+static inline uint64_t abstract_interval_state_hash_wrapper(const Abstract_Dom_Ctx *ctx, const Abstract_State *s) {
+    return abstract_interval_state_hash((const Abstract_Interval_Ctx *) ctx, (const Interval *) s);
+}
+
 static inline Abstract_State *abstract_interval_state_union_wrapper(const Abstract_Dom_Ctx *ctx, const Abstract_State *s1, const Abstract_State *s2) {
     return (Abstract_State *) abstract_interval_state_union((const Abstract_Interval_Ctx *) ctx, (const Interval *) s1, (const Interval *) s2);
 }
@@ -45,16 +61,50 @@ static inline Abstract_State *abstract_interval_state_intersect_wrapper(const Ab
     return (Abstract_State *) abstract_interval_state_intersect((const Abstract_Interval_Ctx *) ctx, (const Interval *) s1, (const Interval *) s2);
 }
 
+static inline Abstract_Exec_Buf *abstract_interval_exec_buf_init_wrapper(const Abstract_Dom_Ctx *ctx) {
+    return (Abstract_Exec_Buf *) abstract_interval_exec_buf_init((const Abstract_Interval_Ctx *) ctx);
+}
+
+static inline void abstract_interval_exec_buf_free_wrapper(Abstract_Exec_Buf *buf) {
+    abstract_interval_exec_buf_free((Interval_Exec_Buf *) buf);
+}
+
+static inline void abstract_interval_state_exec_command_into_wrapper(const Abstract_Dom_Ctx *ctx, Abstract_State *dst, const Abstract_State *s, const Bytecode *command, Abstract_Exec_Buf *buf) {
+    abstract_interval_state_exec_command_into((const Abstract_Interval_Ctx *) ctx, (Interval *) dst, (const Interval *) s, command, (Interval_Exec_Buf *) buf);
+}
+
+static inline void abstract_interval_state_union_into_wrapper(const Abstract_Dom_Ctx *ctx, Abstract_State *dst, const Abstract_State *s1, const Abstract_State *s2) {
+    abstract_interval_state_union_into((const Abstract_Interval_Ctx *) ctx, (Interval *) dst, (const Interval *) s1, (const Interval *) s2);
+}
+
+static inline void abstract_interval_state_widening_into_wrapper(const Abstract_Dom_Ctx *ctx, Abstract_State *dst, const Abstract_State *s1, const Abstract_State *s2) {
+    abstract_interval_state_widening_into((const Abstract_Interval_Ctx *) ctx, (Interval *) dst, (const Interval *) s1, (const Interval *) s2);
+}
+
+static inline void abstract_interval_state_intersect_into_wrapper(const Abstract_Dom_Ctx *ctx, Abstract_State *dst, const Abstract_State *s1, const Abstract_State *s2) {
+    abstract_interval_state_intersect_into((const Abstract_Interval_Ctx *) ctx, (Interval *) dst, (const Interval *) s1, (const Interval *) s2);
+}
+
 const Abstract_Dom_Ops abstract_interval_ops = {
     .ctx_free = abstract_interval_ctx_free_wrapper,
+    .state_init = abstract_interval_state_init_wrapper,
     .state_free = abstract_interval_state_free_wrapper,
+    .state_copy = abstract_interval_state_copy_wrapper,
     .state_set_bottom = abstract_interval_state_set_bottom_wrapper,
     .state_set_top = abstract_interval_state_set_top_wrapper,
     .state_set_from_config = abstract_interval_state_set_from_config_wrapper,
     .state_print = abstract_interval_state_print_wrapper,
     .exec_command = abstract_interval_state_exec_command_wrapper,
     .state_leq = abstract_interval_state_leq_wrapper,
+    .state_equal = abstract_interval_state_equal_wrapper,
+    .state_hash = abstract_interval_state_hash_wrapper,
     .union_ = abstract_interval_state_union_wrapper,
     .widening = abstract_interval_state_widening_wrapper,
     .narrowing = abstract_interval_state_intersect_wrapper,
+    .exec_buf_init = abstract_interval_exec_buf_init_wrapper,
+    .exec_buf_free = abstract_interval_exec_buf_free_wrapper,
+    .exec_command_into = abstract_interval_state_exec_command_into_wrapper,
+    .union_into = abstract_interval_state_union_into_wrapper,
+    .widening_into = abstract_interval_state_widening_into_wrapper,
+    .narrowing_into = abstract_interval_state_intersect_into_wrapper,
 };
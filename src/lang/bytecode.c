@@ -0,0 +1,275 @@
+#include "bytecode.h"
+#include "../common.h"
+#include <assert.h>
+#include <stdlib.h>
+
+static size_t bytecode_emit(Bytecode *bc, Bytecode_Instr instr) {
+    bc->code[bc->count] = instr;
+    return bc->count++;
+}
+
+// Returns the number of instructions of the subtree in 'node'
+static size_t ast_count(const AST_Node *node) {
+    size_t count = 0;
+
+    // Explicit stack, an expression as 'x + 1 + 1 + ... + 1' is a deep tree
+    const AST_Node **stack = NULL;
+    size_t stack_count = 0;
+    size_t stack_capacity = 0;
+
+    for (;;) {
+        // The negations are not emitted
+        while (node->type == NODE_NOT) {
+            node = node->as.child.left;
+        }
+        count++;
+
+        const AST_Node *right = NULL;
+        switch (node->type) {
+        case NODE_NUM:
+        case NODE_VAR:
+        case NODE_BOOL_LITERAL:
+        case NODE_SKIP:
+            break;
+        case NODE_ASSIGN:
+            right = node->as.child.right;
+            break;
+        default:
+            if (stack_count >= stack_capacity) {
+                stack_capacity = stack_capacity == 0 ? 64 : stack_capacity * 2;
+                stack = xrealloc(stack, stack_capacity*sizeof(AST_Node *));
+            }
+            stack[stack_count++] = node->as.child.left;
+            right = node->as.child.right;
+            break;
+        }
+
+        if (right != NULL) {
+            node = right;
+        } else if (stack_count > 0) {
+            node = stack[--stack_count];
+        } else {
+            break;
+        }
+    }
+
+    free(stack);
+    return count;
+}
+
+// Returns the operator of the node, or of its negation if 'negated' is true
+static enum Bytecode_Op bytecode_op(enum Node_Type type, bool negated) {
+    switch (type) {
+    case NODE_PLUS:  return BC_PLUS;
+    case NODE_MINUS: return BC_MINUS;
+    case NODE_MULT:  return BC_MULT;
+    case NODE_DIV:   return BC_DIV;
+    case NODE_EQ:    return negated ? BC_NEQ : BC_EQ;
+    case NODE_LEQ:   return negated ? BC_GT : BC_LEQ;
+    case NODE_NEQ:   return negated ? BC_EQ : BC_NEQ;
+    case NODE_GT:    return negated ? BC_LEQ : BC_GT;
+    case NODE_AND:   return negated ? BC_OR : BC_AND;
+    case NODE_OR:    return negated ? BC_AND : BC_OR;
+    default:
+        assert(0 && "UNREACHABLE");
+    }
+}
+
+// Node of the subtree being emitted, with the state of its visit
+typedef struct {
+    const AST_Node *node;
+    bool negated;
+    bool left_done;   // The left operand is emitted, the right one is next
+    size_t left;      // Index of the root of the left operand
+} Compile_Frame;
+
+// Emit the instructions of the subtree in 'node', returns the index of its root.
+// If 'negated' is true then the negation of the Bexp in 'node' is emitted.
+//
+// The postfix order is the order in which a depth first visit leaves the nodes,
+// the visit uses an explicit stack so deep expressions can not overflow the call stack.
+static size_t bytecode_compile_impl(Bytecode *bc, const AST_Node *node, bool negated) {
+    Compile_Frame *stack = NULL;
+    size_t stack_count = 0;
+    size_t stack_capacity = 0;
+
+    // Root of the last completed subtree
+    size_t root = 0;
+
+    bool descend = true;
+    for (;;) {
+        if (descend) {
+            // The negations are pushed down by the polarity
+            while (node->type == NODE_NOT) {
+                node = node->as.child.left;
+                negated = !negated;
+            }
+
+            Bytecode_Instr instr = {0};
+            instr.start = bc->count;
+            switch (node->type) {
+            case NODE_NUM:
+                instr.op = BC_NUM;
+                instr.as.num = node->as.num;
+                break;
+            case NODE_VAR:
+                instr.op = BC_VAR;
+                instr.as.slot = node->as.var.slot;
+                break;
+            case NODE_BOOL_LITERAL:
+                instr.op = BC_BOOL;
+                instr.as.boolean = node->as.boolean != negated;
+                break;
+            case NODE_PLUS:
+            case NODE_MINUS:
+            case NODE_MULT:
+            case NODE_DIV:
+            case NODE_EQ:
+            case NODE_LEQ:
+            case NODE_NEQ:
+            case NODE_GT:
+            case NODE_AND:
+            case NODE_OR:
+                {
+                    if (stack_count >= stack_capacity) {
+                        stack_capacity = stack_capacity == 0 ? 64 : stack_capacity * 2;
+                        stack = xrealloc(stack, stack_capacity*sizeof(Compile_Frame));
+                    }
+                    Compile_Frame frame = {
+                        .node = node,
+                        .negated = negated,
+                        .left_done = false,
+                    };
+                    stack[stack_count++] = frame;
+
+                    // The negation goes down only to the operands of '&' and '|'
+                    negated = negated && (node->type == NODE_AND || node->type == NODE_OR);
+                    node = node->as.child.left;
+                }
+                continue;
+            default:
+                assert(0 && "UNREACHABLE");
+            }
+
+            root = bytecode_emit(bc, instr);
+            descend = false;
+        }
+
+        if (stack_count == 0) {
+            break;
+        }
+
+        Compile_Frame *frame = &stack[stack_count - 1];
+        if (!frame->left_done) {
+            // Emit the right operand with the same polarity of the left one
+            frame->left_done = true;
+            frame->left = root;
+            negated = frame->negated && (frame->node->type == NODE_AND || frame->node->type == NODE_OR);
+            node = frame->node->as.child.right;
+            descend = true;
+            continue;
+        }
+
+        Bytecode_Instr instr = {0};
+        instr.op = bytecode_op(frame->node->type, frame->negated);
+        instr.left = frame->left;
+        instr.start = bc->code[frame->left].start;
+        root = bytecode_emit(bc, instr);
+        stack_count--;
+    }
+
+    free(stack);
+    return root;
+}
+
+// Returns the maximum number of states on the stack for evaluating the Bexp in 'bc':
+// every literal and comparison pushes a state, every '&' and '|' pops two states and pushes one.
+static size_t bexp_state_depth(const Bytecode *bc) {
+    size_t count = 0;
+    size_t max = 0;
+
+    for (size_t i = 0; i < bc->count; ++i) {
+        switch (bc->code[i].op) {
+        case BC_BOOL:
+        case BC_EQ:
+        case BC_LEQ:
+        case BC_NEQ:
+        case BC_GT:
+            count++;
+            if (count > max) {
+                max = count;
+            }
+            break;
+        case BC_AND:
+        case BC_OR:
+            count--;
+            break;
+        default:
+            break;
+        }
+    }
+
+    return max;
+}
+
+Bytecode bytecode_compile(Arena *arena, const AST_Node *node, bool negated) {
+    Bytecode bc = {0};
+    bc.code = arena_alloc(arena, sizeof(Bytecode_Instr) * ast_count(node));
+
+    Bytecode_Instr instr = {0};
+
+    switch (node->type) {
+    case NODE_SKIP:
+        instr.op = BC_SKIP;
+        bytecode_emit(&bc, instr);
+        break;
+    case NODE_ASSIGN:
+        bytecode_compile_impl(&bc, node->as.child.right, false);
+        instr.op = BC_ASSIGN;
+        instr.as.slot = node->as.child.left->as.var.slot;
+        bytecode_emit(&bc, instr);
+        break;
+    default:
+        bytecode_compile_impl(&bc, node, negated);
+        bc.state_depth = bexp_state_depth(&bc);
+        break;
+    }
+
+    return bc;
+}
+
+Bytecode bytecode_concat(Arena *arena, const Bytecode *const *commands, size_t count) {
+    size_t total = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (commands[i]->code[commands[i]->count - 1].op == BC_ASSIGN) {
+            total += commands[i]->count;
+        }
+    }
+
+    Bytecode bc = {0};
+    if (total == 0) {
+        Bytecode_Instr instr = { .op = BC_SKIP };
+        bc.code = arena_alloc(arena, sizeof(Bytecode_Instr));
+        bytecode_emit(&bc, instr);
+        return bc;
+    }
+
+    bc.code = arena_alloc(arena, sizeof(Bytecode_Instr) * total);
+    for (size_t i = 0; i < count; ++i) {
+        const Bytecode *command = commands[i];
+        if (command->code[command->count - 1].op != BC_ASSIGN) {
+            continue;
+        }
+
+        // The indices of the operands are moved after the previous commands
+        size_t offset = bc.count;
+        for (size_t j = 0; j < command->count; ++j) {
+            Bytecode_Instr instr = command->code[j];
+            instr.left += offset;
+            instr.start += offset;
+            bytecode_emit(&bc, instr);
+        }
+    }
+
+    return bc;
+}
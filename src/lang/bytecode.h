@@ -0,0 +1,83 @@
+#ifndef WHILE_AI_BYTECODE_
+#define WHILE_AI_BYTECODE_
+
+#include "parser.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// Flat representation of a CFG edge command, evaluated by the abstract domains
+// in place of the AST (so without recursion and pointer chasing on the arithmetic).
+//
+// The instructions are in postfix order: the operands of an instruction are before it.
+// The right operand of a binary instruction is always the previous instruction,
+// while the left one is at index 'left'. Every instruction also stores 'start',
+// the first instruction of the subtree rooted on it, so any sub-expression
+// can be evaluated alone running the instructions in [start, root].
+//
+// Example: 'x := y + 2 * z' with y in slot 1 and z in slot 2 becomes:
+//     0: VAR 1
+//     1: NUM 2
+//     2: VAR 2
+//     3: MULT (left = 1, start = 1)
+//     4: PLUS (left = 0, start = 0)
+//     5: ASSIGN x
+//
+// A basic block (see 'cfg_coalesce_blocks') is the concatenation of its assignments,
+// that are executed in order: every BC_ASSIGN ends one of them.
+//
+// The Bexp are compiled in Negation Normal Form, so there is no NOT instruction:
+// the negations are pushed down to the comparisons and literals with the De Morgan laws
+// (for example '!(x <= 1 & y = 2)' becomes 'x > 1 | y != 2').
+enum Bytecode_Op {
+    // Aexp
+    BC_NUM,
+    BC_VAR,
+    BC_PLUS,
+    BC_MINUS,
+    BC_MULT,
+    BC_DIV,
+
+    // Bexp
+    BC_BOOL,
+    BC_EQ,
+    BC_LEQ,
+    BC_NEQ,
+    BC_GT,
+    BC_AND,
+    BC_OR,
+
+    // Commands (always the last instruction of a command)
+    BC_ASSIGN,
+    BC_SKIP,
+};
+
+typedef struct {
+    enum Bytecode_Op op;
+    size_t left;
+    size_t start;
+    union {
+        int64_t num;
+        size_t slot; // Variable slot for BC_VAR and BC_ASSIGN
+        bool boolean;
+    } as;
+} Bytecode_Instr;
+
+typedef struct {
+    Bytecode_Instr *code;
+    size_t count;
+
+    // Maximum number of states on the stack for evaluating the '&' and '|' of a Bexp (0 for the other commands)
+    size_t state_depth;
+} Bytecode;
+
+// Compile the command (assign, skip or bexp) in 'node', the instructions are allocated in 'arena'.
+// If 'negated' is true then the negation of the bexp in 'node' is compiled.
+// The variable slots must be already resolved.
+Bytecode bytecode_compile(Arena *arena, const AST_Node *node, bool negated);
+
+// Returns the concatenation of the 'count' assign and skip commands in 'commands',
+// allocated in 'arena'. The skips are dropped, unless all the commands are skips.
+Bytecode bytecode_concat(Arena *arena, const Bytecode *const *commands, size_t count);
+
+#endif // WHILE_AI_BYTECODE_
@@ -6,45 +6,124 @@
 #include <assert.h>
 #include <string.h>
 
-static CFG_Node build_node(size_t id) {
+// Returns the node 'id' with 'out_count' edges reserved after the ones of the previous nodes
+// (the nodes are built in id order, so the outgoing edges are grouped by source)
+static CFG_Node build_node(CFG *cfg, size_t id, size_t out_count) {
     CFG_Node node = {
         .id = id,
+        .edges = cfg->edges + cfg->edge_count,
         .edge_count = 0,
-        .preds = NULL,
-        .preds_count = 0,
+        .in_edges = NULL,
+        .in_count = 0,
         .is_while = false,
     };
+    cfg->edge_count += out_count;
 
     return node;
 }
 
-static size_t count_nodes(const AST_Node *node, size_t counter) {
-    switch (node->type) {
-    case NODE_ASSIGN:
-    case NODE_SKIP:
-        counter++;
-        break;
-    case NODE_SEQ:
-        counter = count_nodes(node->as.child.left, counter);
-        counter = count_nodes(node->as.child.right, counter);
-        break;
-    case NODE_IF:
-        // 2 Skip nodes + if node
-        counter += 3;
-        counter = count_nodes(node->as.child.left, counter);
-        counter = count_nodes(node->as.child.right, counter);
-        break;
-    case NODE_WHILE:
-        // 2 Skip nodes + loop inv node
-        counter += 3;
-        counter = count_nodes(node->as.child.left, counter);
-        break;
-    default:
-        break;
+/* ==================================== Node stack ==================================== */
+// The AST visits use an explicit stack, so the depth of the tree is bounded only by the heap memory
+typedef struct {
+    AST_Node **data;
+    size_t count;
+    size_t capacity;
+} Node_Stack;
+
+static void node_stack_push(Node_Stack *s, AST_Node *node) {
+    if (s->count >= s->capacity) {
+        if (s->capacity == 0) {
+            s->capacity = 64;
+        } else {
+            s->capacity *= 2;
+        }
+        s->data = xrealloc(s->data, s->capacity*sizeof(AST_Node *));
     }
+    s->data[s->count++] = node;
+}
+/* //////////////////////////////////////////////////////////////////////////////////// */
+
+// Returns the number of CFG nodes of the program (the final node included),
+// the number of edges is written in 'edge_count'
+static size_t count_nodes(AST_Node *root, size_t *edge_count) {
+    size_t counter = 1;
+    *edge_count = 0;
+    Node_Stack s = {0};
+    node_stack_push(&s, root);
+
+    while (s.count > 0) {
+        AST_Node *node = s.data[--s.count];
+        switch (node->type) {
+        case NODE_ASSIGN:
+        case NODE_SKIP:
+            counter++;
+            *edge_count += 1;
+            break;
+        case NODE_SEQ:
+            node_stack_push(&s, node->as.child.left);
+            node_stack_push(&s, node->as.child.right);
+            break;
+        case NODE_IF:
+            // 2 Skip nodes + if node (with 2 edges)
+            counter += 3;
+            *edge_count += 4;
+            node_stack_push(&s, node->as.child.left);
+            node_stack_push(&s, node->as.child.right);
+            break;
+        case NODE_WHILE:
+            // 2 Skip nodes + loop inv node (with 2 edges)
+            counter += 3;
+            *edge_count += 4;
+            node_stack_push(&s, node->as.child.left);
+            break;
+        default:
+            break;
+        }
+    }
+
+    free(s.data);
     return counter;
 }
 
+// Set the slot of every variable node in the tree with its index in 'vars'
+static void resolve_vars(AST_Node *root, const Variables *vars) {
+    Node_Stack s = {0};
+    node_stack_push(&s, root);
+
+    while (s.count > 0) {
+        AST_Node *node = s.data[--s.count];
+        if (node == NULL) {
+            continue;
+        }
+
+        if (node->type == NODE_VAR) {
+            String var = {
+                .name = node->as.var.name,
+                .len = node->as.var.len,
+            };
+            node->as.var.slot = vars_index_of(vars, var);
+            assert(node->as.var.slot != SIZE_MAX && "Variable not collected");
+        }
+        else if (node->type != NODE_NUM && node->type != NODE_BOOL_LITERAL) {
+            node_stack_push(&s, node->as.child.left);
+            node_stack_push(&s, node->as.child.right);
+            node_stack_push(&s, node->as.child.condition);
+        }
+    }
+
+    free(s.data);
+}
+
+// Lower the commands of all the edges into their bytecode.
+// The negated conditions of the false edges are normalized here (see bytecode.h),
+// so the execution of a guard never rewrites the AST.
+static void compile_edges(CFG *cfg, Arena *arena) {
+    for (size_t i = 0; i < cfg->edge_count; ++i) {
+        CFG_Edge *edge = &cfg->edges[i];
+        edge->bytecode = bytecode_compile(arena, edge->command, edge->negated);
+    }
+}
+
 /* ================================ Predecessor stack ================================= */
 typedef struct {
     size_t *data;
@@ -77,18 +156,8 @@ size_t pred_stack_pop(Pred_Stack *s) {
 
 
 // Links all the elements in the stack of the predecessors to the current node.
+// The incoming edges are collected only at the end (see 'collect_in_edges').
 static void wire_predecessors(CFG *cfg, size_t cur_node, Pred_Stack *preds) {
-
-    // Copy the predecessors in the current node struct.
-    //
-    // This function can be called multiple times wiring the same node, so for collecting
-    // all the preds we do a realloc every time (the first time will be a simple malloc).
-    size_t cur_node_preds_count = cfg->nodes[cur_node].preds_count; // Prev preds count
-    cfg->nodes[cur_node].preds_count += preds->count;
-    cfg->nodes[cur_node].preds = xrealloc(cfg->nodes[cur_node].preds, sizeof(size_t)*cfg->nodes[cur_node].preds_count);
-    memcpy(cfg->nodes[cur_node].preds + cur_node_preds_count, preds->data, sizeof(size_t)*preds->count);
-
-    // Linking the edges
     while (preds->count != 0) {
         size_t pred = pred_stack_pop(preds);
         size_t prev_node_edge_count = cfg->nodes[pred].edge_count;
@@ -101,157 +170,203 @@ static void wire_predecessors(CFG *cfg, size_t cur_node, Pred_Stack *preds) {
     }
 }
 
-// Build the CFG using the AST node.
-//
-// The contruction follows the struct of the AST, exploring recusively the tree.
-//
-// For each stmt node it saves the information of the current node (src, type and structures)
-// into the edge that will point to the next node (even if we don't know the next, in fact 'dst' will be -1).
-//
-// Then when we are on the successor node we can link to the predecessor using the 'wire_predecessors' utility.
-// For tracing all the predecessors (that can be arbitrary) we use the 'preds' stack.
-static void build_cfg_impl(CFG *cfg, const AST_Node *node, size_t *counter, Pred_Stack *preds) {
-    switch (node->type) {
-    case NODE_SKIP:
-    case NODE_ASSIGN:
-        // Create the assign node
-        cfg->nodes[*counter] = build_node(*counter);
-        cfg->nodes[*counter].edges[0].src = *counter;
-        cfg->nodes[*counter].edges[0].dst = -1;
-        enum Edge_Type type = node->type == NODE_ASSIGN ? EDGE_ASSIGN : EDGE_SKIP;
-        cfg->nodes[*counter].edges[0].type = type;
-        cfg->nodes[*counter].edges[0].command = parser_copy_node(node);
-
-        wire_predecessors(cfg, *counter, preds);
-
-        pred_stack_push(preds, *counter);
-        *counter += 1;
-        break;
-    case NODE_SEQ:
-        build_cfg_impl(cfg, node->as.child.left, counter, preds);
-        build_cfg_impl(cfg, node->as.child.right, counter, preds);
-        break;
-    case NODE_IF:
-        // If node
-        cfg->nodes[*counter] = build_node(*counter);
-
-        cfg->nodes[*counter].edges[0].src = *counter;
-        cfg->nodes[*counter].edges[0].dst = -1;
-        cfg->nodes[*counter].edges[0].type = EDGE_GUARD;
-        cfg->nodes[*counter].edges[0].command = parser_copy_node(node->as.child.condition);
-
-        cfg->nodes[*counter].edges[1].src = *counter;
-        cfg->nodes[*counter].edges[1].dst = -1;
-        cfg->nodes[*counter].edges[1].type = EDGE_GUARD;
-
-        // Negate the condition node for getting the false case
-        AST_Node *false_cond = create_node(NODE_NOT);
-        false_cond->as.child.left = parser_copy_node(node->as.child.condition);
-        cfg->nodes[*counter].edges[1].command = false_cond;
-
-        wire_predecessors(cfg, *counter, preds);
-
-        const size_t if_cond = *counter;
-        pred_stack_push(preds, *counter);
-        *counter += 1;
-
-        // Build the two branch, saving the predecessors
-        build_cfg_impl(cfg, node->as.child.left, counter, preds);
-
-        // Add a skip node after the last stmt of then branch
-        AST_Node *skip = create_node(NODE_SKIP);
-        build_cfg_impl(cfg, skip, counter, preds);
-        free(skip);
-
-        Pred_Stack preds_then_branch = {0};
-        while (preds->count != 0) {
-            pred_stack_push(&preds_then_branch, pred_stack_pop(preds));
-        }
-
-        pred_stack_push(preds, if_cond);
-
-        build_cfg_impl(cfg, node->as.child.right, counter, preds);
+// Command of the skip nodes added by the construction (shared by all their edges)
+static const AST_Node skip_command = { .type = NODE_SKIP };
 
-        // Add a skip node after the last stmt of else branch
-        skip = create_node(NODE_SKIP);
-        build_cfg_impl(cfg, skip, counter, preds);
-        free(skip);
+// Create the node of an assign or skip command, successor of all the nodes in 'preds'
+static void build_command_node(CFG *cfg, const AST_Node *node, size_t *counter, Pred_Stack *preds) {
+    cfg->nodes[*counter] = build_node(cfg, *counter, 1);
+    cfg->nodes[*counter].edges[0].src = *counter;
+    cfg->nodes[*counter].edges[0].dst = -1;
+    enum Edge_Type type = node->type == NODE_ASSIGN ? EDGE_ASSIGN : EDGE_SKIP;
+    cfg->nodes[*counter].edges[0].type = type;
+    cfg->nodes[*counter].edges[0].command = node;
 
-        Pred_Stack preds_else_branch = {0};
-        while (preds->count != 0) {
-            pred_stack_push(&preds_else_branch, pred_stack_pop(preds));
-        }
-
-        // Add the predecessors of the if stmt
-        while (preds_then_branch.count != 0) {
-            pred_stack_push(preds, pred_stack_pop(&preds_then_branch));
-        }
-        while (preds_else_branch.count != 0) {
-            pred_stack_push(preds, pred_stack_pop(&preds_else_branch));
-        }
+    wire_predecessors(cfg, *counter, preds);
 
-        free(preds_then_branch.data);
-        free(preds_else_branch.data);
-        break;
-    case NODE_WHILE:
-
-        // Add a skip node before the loop invariant node
-        {
-            AST_Node *skip = create_node(NODE_SKIP);
-            build_cfg_impl(cfg, skip, counter, preds);
-            free(skip);
-        }
-
-        // Loop invariant Node
-        cfg->nodes[*counter] = build_node(*counter);
-        cfg->nodes[*counter].is_while = true;
+    pred_stack_push(preds, *counter);
+    *counter += 1;
+}
 
-        cfg->nodes[*counter].edges[0].src = *counter;
-        cfg->nodes[*counter].edges[0].dst = -1;
-        cfg->nodes[*counter].edges[0].type = EDGE_GUARD;
-        cfg->nodes[*counter].edges[0].command = parser_copy_node(node->as.child.condition);
+// Create the node of an if or while condition, the false edge shares the condition node negated
+static void build_guard_node(CFG *cfg, const AST_Node *node, size_t *counter, Pred_Stack *preds) {
+    cfg->nodes[*counter] = build_node(cfg, *counter, 2);
+    cfg->nodes[*counter].is_while = node->type == NODE_WHILE;
 
-        cfg->nodes[*counter].edges[1].src = *counter;
-        cfg->nodes[*counter].edges[1].dst = -1;
-        cfg->nodes[*counter].edges[1].type = EDGE_GUARD;
+    cfg->nodes[*counter].edges[0].src = *counter;
+    cfg->nodes[*counter].edges[0].dst = -1;
+    cfg->nodes[*counter].edges[0].type = EDGE_GUARD;
+    cfg->nodes[*counter].edges[0].command = node->as.child.condition;
 
-        // Negate the condition node for getting the exit condition
-        AST_Node *exit_cond = create_node(NODE_NOT);
-        exit_cond->as.child.left = parser_copy_node(node->as.child.condition);
-        cfg->nodes[*counter].edges[1].command = exit_cond;
+    cfg->nodes[*counter].edges[1].src = *counter;
+    cfg->nodes[*counter].edges[1].dst = -1;
+    cfg->nodes[*counter].edges[1].type = EDGE_GUARD;
+    cfg->nodes[*counter].edges[1].command = node->as.child.condition;
+    cfg->nodes[*counter].edges[1].negated = true;
 
-        wire_predecessors(cfg, *counter, preds);
+    wire_predecessors(cfg, *counter, preds);
 
-        const size_t loop_inv = *counter;
-        pred_stack_push(preds, *counter);
-        *counter += 1;
+    pred_stack_push(preds, *counter);
+    *counter += 1;
+}
 
-        build_cfg_impl(cfg, node->as.child.left, counter, preds);
+/* ==================================== Build stack =================================== */
+// Work still to do for building the CFG, the tasks are run in LIFO order
+enum Build_Task_Type {
+    BUILD_STMT,      // Build the nodes of the stmt in 'node'
+    BUILD_ELSE,      // The then branch is built, the else branch starts from the if node 'id'
+    BUILD_JOIN,      // The else branch is built, 'id' is the last node of the then branch
+    BUILD_BACK_EDGE, // The while body is built, 'id' is the loop invariant node
+};
 
-        // Add a skip node after the last stmt of the while body
-        skip = create_node(NODE_SKIP);
-        build_cfg_impl(cfg, skip, counter, preds);
-        free(skip);
+typedef struct {
+    enum Build_Task_Type type;
+    const AST_Node *node;
+    size_t id;
+} Build_Task;
 
-        wire_predecessors(cfg, loop_inv, preds);
+typedef struct {
+    Build_Task *data;
+    size_t count;
+    size_t capacity;
+} Build_Stack;
 
-        // The predecessor of a statement after the while is the loop invariant
-        pred_stack_push(preds, loop_inv);
-        break;
-    default:
-        break;
+static void build_stack_push(Build_Stack *s, enum Build_Task_Type type, const AST_Node *node, size_t id) {
+    if (s->count >= s->capacity) {
+        if (s->capacity == 0) {
+            s->capacity = 64;
+        } else {
+            s->capacity *= 2;
+        }
+        s->data = xrealloc(s->data, s->capacity*sizeof(Build_Task));
     }
+    s->data[s->count].type = type;
+    s->data[s->count].node = node;
+    s->data[s->count].id = id;
+    s->count++;
 }
+/* //////////////////////////////////////////////////////////////////////////////////// */
 
+// Build the CFG using the AST node.
+//
+// The contruction follows the struct of the AST, exploring the tree in depth first order
+// with an explicit stack of tasks (the parts of an if or while that come after a nested stmt).
+//
+// For each stmt node it saves the information of the current node (src, type and structures)
+// into the edge that will point to the next node (even if we don't know the next, in fact 'dst' will be -1).
+//
+// Then when we are on the successor node we can link to the predecessor using the 'wire_predecessors' utility.
+// For tracing all the predecessors (that can be arbitrary) we use the 'preds' stack.
+// After a stmt followed by a skip node (the branches and the while body) 'preds' holds only that skip node.
 static void build_cfg(CFG *cfg, const AST_Node *root) {
     size_t counter = 0;
     Pred_Stack preds = {0};
-    build_cfg_impl(cfg, root, &counter, &preds);
+    Build_Stack tasks = {0};
+    build_stack_push(&tasks, BUILD_STMT, root, 0);
+
+    while (tasks.count > 0) {
+        Build_Task task = tasks.data[--tasks.count];
+        const AST_Node *node = task.node;
+
+        switch (task.type) {
+        case BUILD_STMT:
+            switch (node->type) {
+            case NODE_SKIP:
+            case NODE_ASSIGN:
+                build_command_node(cfg, node, &counter, &preds);
+                break;
+            case NODE_SEQ:
+                build_stack_push(&tasks, BUILD_STMT, node->as.child.right, 0);
+                build_stack_push(&tasks, BUILD_STMT, node->as.child.left, 0);
+                break;
+            case NODE_IF:
+                {
+                    const size_t if_cond = counter;
+                    build_guard_node(cfg, node, &counter, &preds);
+
+                    build_stack_push(&tasks, BUILD_ELSE, node, if_cond);
+                    build_stack_push(&tasks, BUILD_STMT, node->as.child.left, 0);
+                }
+                break;
+            case NODE_WHILE:
+                {
+                    // Add a skip node before the loop invariant node
+                    build_command_node(cfg, &skip_command, &counter, &preds);
+
+                    const size_t loop_inv = counter;
+                    build_guard_node(cfg, node, &counter, &preds);
 
-    cfg->nodes[counter] = build_node(counter);
+                    build_stack_push(&tasks, BUILD_BACK_EDGE, node, loop_inv);
+                    build_stack_push(&tasks, BUILD_STMT, node->as.child.left, 0);
+                }
+                break;
+            default:
+                break;
+            }
+            break;
+        case BUILD_ELSE:
+            {
+                // Add a skip node after the last stmt of then branch
+                build_command_node(cfg, &skip_command, &counter, &preds);
+                const size_t then_end = pred_stack_pop(&preds);
+
+                pred_stack_push(&preds, task.id);
+
+                build_stack_push(&tasks, BUILD_JOIN, node, then_end);
+                build_stack_push(&tasks, BUILD_STMT, node->as.child.right, 0);
+            }
+            break;
+        case BUILD_JOIN:
+            {
+                // Add a skip node after the last stmt of else branch
+                build_command_node(cfg, &skip_command, &counter, &preds);
+                const size_t else_end = pred_stack_pop(&preds);
+
+                // The predecessors of the stmt after the if
+                pred_stack_push(&preds, task.id);
+                pred_stack_push(&preds, else_end);
+            }
+            break;
+        case BUILD_BACK_EDGE:
+            // Add a skip node after the last stmt of the while body
+            build_command_node(cfg, &skip_command, &counter, &preds);
+
+            wire_predecessors(cfg, task.id, &preds);
+
+            // The predecessor of a statement after the while is the loop invariant
+            pred_stack_push(&preds, task.id);
+            break;
+        }
+    }
+
+    cfg->nodes[counter] = build_node(cfg, counter, 0);
     wire_predecessors(cfg, counter, &preds);
 
     free(preds.data);
+    free(tasks.data);
+}
+
+// Fill 'cfg->in_edges' grouping the edges by destination (counting sort),
+// the incoming edges of a node are in the order of their sources
+static void collect_in_edges(CFG *cfg) {
+    for (size_t i = 0; i < cfg->edge_count; ++i) {
+        cfg->nodes[cfg->edges[i].dst].in_count++;
+    }
+
+    // Start of the incoming edges of each node, used as insertion point
+    size_t *next = xmalloc(sizeof(size_t) * cfg->count);
+    size_t start = 0;
+    for (size_t i = 0; i < cfg->count; ++i) {
+        next[i] = start;
+        cfg->nodes[i].in_edges = cfg->in_edges + start;
+        start += cfg->nodes[i].in_count;
+    }
+
+    for (size_t i = 0; i < cfg->edge_count; ++i) {
+        cfg->in_edges[next[cfg->edges[i].dst]++] = i;
+    }
+
+    free(next);
 }
 
 void cfg_print_graphviz(const CFG *cfg, FILE *fp) {
@@ -269,7 +384,13 @@ void cfg_print_graphviz(const CFG *cfg, FILE *fp) {
                 break;
             case EDGE_GUARD:
                 fprintf(fp, " [label=\"");
-                parser_print_ast(node.edges[j].command, fp);
+                if (node.edges[j].negated) {
+                    fprintf(fp, " (!");
+                    parser_print_ast(node.edges[j].command, fp);
+                    fprintf(fp, ")");
+                } else {
+                    parser_print_ast(node.edges[j].command, fp);
+                }
                 fprintf(fp, "\"]\n");
                 break;
             case EDGE_SKIP:
@@ -281,30 +402,169 @@ void cfg_print_graphviz(const CFG *cfg, FILE *fp) {
     fprintf(fp, "}\n");
 }
 
-CFG *cfg_get(const AST_Node *root) {
-    CFG *cfg = xmalloc(sizeof(CFG));
-    cfg->count = count_nodes(root, 1);
-    cfg->nodes = xmalloc(sizeof(CFG_Node)*(cfg->count));
+// One allocation for the whole graph, 'cfg->edge_count' is the number of edges reserved so far
+static CFG *cfg_alloc(Arena *arena, size_t count, size_t edge_count) {
+    CFG *cfg = arena_alloc(arena, sizeof(CFG) + sizeof(CFG_Node)*count + (sizeof(CFG_Edge) + sizeof(size_t))*edge_count);
+    cfg->count = count;
+    cfg->nodes = (CFG_Node *)(cfg + 1);
+    cfg->edges = (CFG_Edge *)(cfg->nodes + count);
+    cfg->in_edges = (size_t *)(cfg->edges + edge_count);
+    cfg->edge_count = 0;
+
+    return cfg;
+}
+
+CFG *cfg_get(AST_Node *root, const Variables *vars, Arena *arena) {
+    resolve_vars(root, vars);
+
+    size_t edge_count = 0;
+    size_t count = count_nodes(root, &edge_count);
+
+    CFG *cfg = cfg_alloc(arena, count, edge_count);
     build_cfg(cfg, root);
+    assert(cfg->edge_count == edge_count);
+    collect_in_edges(cfg);
+    compile_edges(cfg, arena);
 
     return cfg;
 }
 
-void cfg_free(CFG *cfg) {
-    // Free the AST nodes in the edges
+static bool is_skip_node(const CFG *cfg, size_t id) {
+    const CFG_Node *node = &cfg->nodes[id];
+    return id != 0 && node->edge_count == 1 && node->edges[0].type == EDGE_SKIP;
+}
+
+CFG *cfg_contract_skips(const CFG *cfg, size_t *point, Arena *arena) {
+    // Node that takes the place of each node, following the chains of skip nodes.
+    // A skip edge goes forward, or back to a loop head that is not a skip node,
+    // so walking the ids backward the successor is already resolved.
+    size_t *rep = xmalloc(sizeof(size_t) * cfg->count);
+    for (size_t i = cfg->count; i-- > 0;) {
+        rep[i] = i;
+        if (is_skip_node(cfg, i)) {
+            size_t dst = cfg->nodes[i].edges[0].dst;
+            assert((dst > i || !is_skip_node(cfg, dst)) && "Skip edge back to a skip node");
+            rep[i] = dst > i ? rep[dst] : dst;
+        }
+    }
+
+    size_t count = 0;
+    size_t edge_count = 0;
+    for (size_t i = 0; i < cfg->count; ++i) {
+        if (rep[i] == i) {
+            point[i] = count++;
+            edge_count += cfg->nodes[i].edge_count;
+        } else {
+            point[i] = SIZE_MAX;
+        }
+    }
+
+    CFG *res = cfg_alloc(arena, count, edge_count);
+    for (size_t i = 0; i < cfg->count; ++i) {
+        if (point[i] == SIZE_MAX) {
+            continue;
+        }
+
+        const CFG_Node *node = &cfg->nodes[i];
+        CFG_Node *res_node = &res->nodes[point[i]];
+        res_node->id = point[i];
+        res_node->edges = res->edges + res->edge_count;
+        res_node->edge_count = node->edge_count;
+        res_node->is_while = node->is_while;
+
+        for (size_t j = 0; j < node->edge_count; ++j) {
+            CFG_Edge edge = node->edges[j];
+            edge.src = point[i];
+            edge.dst = point[rep[edge.dst]];
+            res->edges[res->edge_count++] = edge;
+        }
+    }
+
+    collect_in_edges(res);
+
+    free(rep);
+    return res;
+}
+
+static bool is_straight_edge(const CFG_Edge *edge) {
+    return edge->type == EDGE_ASSIGN || edge->type == EDGE_SKIP;
+}
+
+// A node inside a basic block: reached only by an assign or skip edge, and left by only one of them
+static bool is_block_inner_node(const CFG *cfg, size_t id) {
+    const CFG_Node *node = &cfg->nodes[id];
+    if (id == 0 || node->is_while || node->in_count != 1 || node->edge_count != 1) {
+        return false;
+    }
+
+    const CFG_Edge *in = &cfg->edges[node->in_edges[0]];
+    return in->src != id && is_straight_edge(in) && is_straight_edge(&node->edges[0]);
+}
+
+CFG *cfg_coalesce_blocks(const CFG *cfg, size_t *point, Arena *arena) {
+    bool *inner = xmalloc(sizeof(bool) * cfg->count);
+
+    size_t count = 0;
+    size_t edge_count = 0;
     for (size_t i = 0; i < cfg->count; ++i) {
-        CFG_Node node = cfg->nodes[i];
-        for (size_t j = 0; j < node.edge_count; ++j) {
-            CFG_Edge edge = node.edges[j];
-            parser_free_ast_node(edge.command);
+        inner[i] = is_block_inner_node(cfg, i);
+        if (inner[i]) {
+            point[i] = SIZE_MAX;
+        } else {
+            point[i] = count++;
+            edge_count += cfg->nodes[i].edge_count;
         }
+    }
 
-        // Predecessors array free
-        if (node.preds != NULL) {
-            free(node.preds);
+    // Commands of the block being coalesced
+    const Bytecode **commands = NULL;
+    size_t commands_capacity = 0;
+
+    CFG *res = cfg_alloc(arena, count, edge_count);
+    for (size_t i = 0; i < cfg->count; ++i) {
+        if (inner[i]) {
+            continue;
+        }
+
+        const CFG_Node *node = &cfg->nodes[i];
+        CFG_Node *res_node = &res->nodes[point[i]];
+        res_node->id = point[i];
+        res_node->edges = res->edges + res->edge_count;
+        res_node->edge_count = node->edge_count;
+        res_node->is_while = node->is_while;
+
+        for (size_t j = 0; j < node->edge_count; ++j) {
+            CFG_Edge edge = node->edges[j];
+            edge.src = point[i];
+
+            // Follow the block up to its last node, collecting the commands
+            size_t commands_count = 0;
+            const CFG_Edge *cur = &node->edges[j];
+            for (;;) {
+                if (commands_count >= commands_capacity) {
+                    commands_capacity = commands_capacity == 0 ? 64 : commands_capacity * 2;
+                    commands = xrealloc(commands, commands_capacity*sizeof(Bytecode *));
+                }
+                commands[commands_count++] = &cur->bytecode;
+
+                if (!inner[cur->dst]) break;
+                cur = &cfg->nodes[cur->dst].edges[0];
+                if (cur->type == EDGE_ASSIGN) {
+                    edge.type = EDGE_ASSIGN;
+                }
+            }
+
+            edge.dst = point[cur->dst];
+            if (commands_count > 1) {
+                edge.bytecode = bytecode_concat(arena, commands, commands_count);
+            }
+            res->edges[res->edge_count++] = edge;
         }
     }
 
-    free(cfg->nodes);
-    free(cfg);
+    collect_in_edges(res);
+
+    free(commands);
+    free(inner);
+    return res;
 }
@@ -2,6 +2,7 @@
 #define WHILE_AI_CFG_
 
 #include "parser.h"
+#include "bytecode.h"
 #include <stdio.h>
 
 enum Edge_Type {
@@ -17,43 +18,75 @@ struct CFG_Edge {
     size_t src; // Node src id
     size_t dst; // Node dst id
     enum Edge_Type type;
-    AST_Node *command;
+
+    // Node of the AST (shared, not a copy), used for printing the CFG.
+    // The two edges of an if/while node point to the same condition,
+    // and in the false one 'negated' is set.
+    const AST_Node *command;
+    bool negated;
+
+    Bytecode bytecode;  // Used by the abstract domains for executing the command
 };
 
 struct CFG_Node{
     size_t id;
 
-    // Array of edges that *starts* from this point.
+    // Edges that *starts* from this point, they are in 'cfg->edges'.
     //
-    // The size is fixed because one node can have at maximum 2 edges in output.
+    // One node can have at maximum 2 edges in output.
     // This is true only for the While Language, because it does not have like
     // switch case and similar.
     //
     // Note: When we are on a while loop/if stmt node then
     //       the first edge is the true condition,
     //       and the second is the false condition.
-    CFG_Edge edges[2];
+    CFG_Edge *edges;
     size_t edge_count;
 
-    // Array of nodes that have an edge coming here
-    size_t *preds;
-    size_t preds_count;
+    // Edges that *ends* in this point, every element is the index of the edge in 'cfg->edges'
+    const size_t *in_edges;
+    size_t in_count;
 
     bool is_while;
 };
 
+// The edges are in Compressed Sparse Row layout: the outgoing edges of all the nodes
+// are in one array grouped by source (in id order), and the incoming ones are
+// in another array grouped by destination. So an edge has a stable index in 'edges',
+// and the nodes, the edges and the incoming edges are allocated all together.
 typedef struct {
     size_t count;
     CFG_Node *nodes;
+
+    CFG_Edge *edges;
+    size_t edge_count;
+
+    size_t *in_edges;
 } CFG;
 
-// Construct and returns the CFG
-CFG *cfg_get(const AST_Node *root);
+// Construct and returns the CFG.
+// The variables of the AST are resolved in place to their index in 'vars',
+// so every variable of the program must be in 'vars'.
+//
+// All the CFG memory (nodes, edges and bytecode) is allocated in 'arena',
+// while the edge commands point into the AST: both must outlive the CFG.
+CFG *cfg_get(AST_Node *root, const Variables *vars, Arena *arena);
+
+// Returns the CFG with the skip nodes contracted (the nodes whose only edge is a skip, apart from P0):
+// their incoming edges go directly to their successor, that gets the same state
+// because the skip transfer function is the identity.
+//
+// 'point' (of 'cfg->count' elements) maps each node of 'cfg' to its id in the returned CFG
+// (the order is preserved), or to SIZE_MAX if it was contracted.
+// The returned CFG shares the commands and the bytecode with 'cfg', it is allocated in 'arena'.
+CFG *cfg_contract_skips(const CFG *cfg, size_t *point, Arena *arena);
+
+// Returns the CFG with the basic blocks coalesced: every maximal chain of assign and skip edges,
+// whose inner nodes have no other edges, becomes one edge that executes all the chain commands.
+// The inner nodes are removed, 'point' is filled as in 'cfg_contract_skips'.
+CFG *cfg_coalesce_blocks(const CFG *cfg, size_t *point, Arena *arena);
 
 // Prints to 'fp' the Graphviz representation of the CFG
 void cfg_print_graphviz(const CFG *cfg, FILE *fp);
 
-// Free the CFG
-void cfg_free(CFG *cfg);
-
 #endif // WHILE_AI_CFG_
@@ -11,46 +11,49 @@
 struct Lexer {
     const char *src;
     const char *cursor;
-};
 
-// List of language keywords with associated type
-typedef struct {
-    const char *keyword;
-    enum Token_Type type;
-} Keyword_Token;
-
-const Keyword_Token keywords[] = {
-    { .keyword = "("     , .type = TOKEN_OPAR    },
-    { .keyword = ")"     , .type = TOKEN_CPAR    },
-    { .keyword = "+"     , .type = TOKEN_PLUS    },
-    { .keyword = "-"     , .type = TOKEN_MINUS   },
-    { .keyword = "*"     , .type = TOKEN_MULT    },
-    { .keyword = "/"     , .type = TOKEN_DIV     },
-    { .keyword = "true"  , .type = TOKEN_TRUE    },
-    { .keyword = "false" , .type = TOKEN_FALSE   },
-    { .keyword = "="     , .type = TOKEN_EQ      },
-    { .keyword = "<="    , .type = TOKEN_LEQ     },
-    { .keyword = "!"     , .type = TOKEN_NOT     },
-    { .keyword = "&"     , .type = TOKEN_AND     },
-    { .keyword = ":="    , .type = TOKEN_ASSIGN  },
-    { .keyword = "skip"  , .type = TOKEN_SKIP    },
-    { .keyword = ";"     , .type = TOKEN_SEMICOL },
-    { .keyword = "if"    , .type = TOKEN_IF      },
-    { .keyword = "then"  , .type = TOKEN_THEN    },
-    { .keyword = "else"  , .type = TOKEN_ELSE    },
-    { .keyword = "fi"    , .type = TOKEN_FI      },
-    { .keyword = "while" , .type = TOKEN_WHILE   },
-    { .keyword = "do"    , .type = TOKEN_DO      },
-    { .keyword = "done"  , .type = TOKEN_DONE    },
+    // Token stream, filled once by 'lex_init'
+    Token *tokens;
+    size_t count;
+    size_t capacity;
+
+    // Index of the next token
+    size_t pos;
 };
 
-const size_t keywords_len = sizeof(keywords) / sizeof(keywords[0]);
+// Returns the type of the keyword in 'word', or TOKEN_VAR if it is not a keyword.
+// The word is classified by its length and then compared only with the keywords of that length.
+static enum Token_Type classify_word(const char *word, size_t len) {
+    switch (len) {
+    case 2:
+        if (memcmp(word, "if", 2) == 0) return TOKEN_IF;
+        if (memcmp(word, "fi", 2) == 0) return TOKEN_FI;
+        if (memcmp(word, "do", 2) == 0) return TOKEN_DO;
+        break;
+    case 4:
+        switch (word[0]) {
+        case 't':
+            if (memcmp(word, "true", 4) == 0) return TOKEN_TRUE;
+            if (memcmp(word, "then", 4) == 0) return TOKEN_THEN;
+            break;
+        case 's':
+            if (memcmp(word, "skip", 4) == 0) return TOKEN_SKIP;
+            break;
+        case 'e':
+            if (memcmp(word, "else", 4) == 0) return TOKEN_ELSE;
+            break;
+        case 'd':
+            if (memcmp(word, "done", 4) == 0) return TOKEN_DONE;
+            break;
+        }
+        break;
+    case 5:
+        if (memcmp(word, "false", 5) == 0) return TOKEN_FALSE;
+        if (memcmp(word, "while", 5) == 0) return TOKEN_WHILE;
+        break;
+    }
 
-Lexer *lex_init(const char *src) {
-    Lexer *lex = xmalloc(sizeof(Lexer));
-    lex->src = src;
-    lex->cursor = src;
-    return lex;
+    return TOKEN_VAR;
 }
 
 static void skip_space(Lexer *lex) {
@@ -59,31 +62,8 @@ static void skip_space(Lexer *lex) {
     }
 }
 
-// Check if 'kt.keyword' is pointed by the lexer cursor.
-// True case => returns the token associated with that keyword and updates the cursor.
-// Otherwise => returns a token with EOF type.
-static Token check_keyword(Lexer *lex, Keyword_Token kt) {
-    Token t = {0};
-
-    if (strncmp(lex->cursor, kt.keyword, strlen(kt.keyword)) == 0) {
-
-        // A variable like 'whileCounter' will be tokenize as 'while' and 'Counter'.
-        // Here I should check that after the keyword there is no alphanumeric char.
-        if (isalnum(kt.keyword[0]) && isalnum(lex->cursor[strlen(kt.keyword)])) {
-            return t;
-        }
-
-        t.type = kt.type;
-        t.as.str.name = lex->cursor;
-        t.as.str.len = strlen(kt.keyword);
-
-        lex->cursor += t.as.str.len;
-    }
-
-    return t;
-}
-
-Token lex_next(Lexer *lex) {
+// Scan the token at the cursor
+static Token lex_scan(Lexer *lex) {
     Token t = {0};
 
     skip_space(lex);
@@ -111,16 +91,8 @@ Token lex_next(Lexer *lex) {
         return t;
     }
 
-    // Keywords
-    for (size_t i = 0; i < keywords_len; ++i) {
-        t = check_keyword(lex, keywords[i]);
-
-        if (t.type != TOKEN_EOF) {
-            return t;
-        }
-    }
-
-    // Variables (alphanum and start with alpha)
+    // Keywords and variables (alphanum and start with alpha).
+    // The whole word is scanned, so a variable like 'whileCounter' is not split into 'while' and 'Counter'.
     if (isalpha(*lex->cursor)) {
         const char *start = lex->cursor;
 
@@ -128,9 +100,43 @@ Token lex_next(Lexer *lex) {
             lex->cursor++;
         }
 
-        t.type = TOKEN_VAR;
         t.as.str.name = start;
         t.as.str.len = lex->cursor - start;
+        t.type = classify_word(start, t.as.str.len);
+        return t;
+    }
+
+    // Symbols, dispatched on the first char
+    t.as.str.name = lex->cursor;
+    t.as.str.len = 1;
+
+    switch (*lex->cursor) {
+    case '(': t.type = TOKEN_OPAR;    break;
+    case ')': t.type = TOKEN_CPAR;    break;
+    case '+': t.type = TOKEN_PLUS;    break;
+    case '-': t.type = TOKEN_MINUS;   break;
+    case '*': t.type = TOKEN_MULT;    break;
+    case '/': t.type = TOKEN_DIV;     break;
+    case '=': t.type = TOKEN_EQ;      break;
+    case '!': t.type = TOKEN_NOT;     break;
+    case '&': t.type = TOKEN_AND;     break;
+    case ';': t.type = TOKEN_SEMICOL; break;
+    case '<':
+        if (lex->cursor[1] == '=') {
+            t.type = TOKEN_LEQ;
+            t.as.str.len = 2;
+        }
+        break;
+    case ':':
+        if (lex->cursor[1] == '=') {
+            t.type = TOKEN_ASSIGN;
+            t.as.str.len = 2;
+        }
+        break;
+    }
+
+    if (t.type != TOKEN_EOF) {
+        lex->cursor += t.as.str.len;
         return t;
     }
 
@@ -138,27 +144,58 @@ Token lex_next(Lexer *lex) {
     exit(1);
 }
 
-Token lex_peek(Lexer *lex) {
-    // Get token and then rewind the cursor
-    const char *cursor = lex->cursor;
-    Token t = lex_next(lex);
-    lex->cursor = cursor;
+static void lex_push(Lexer *lex, Token t) {
+    if (lex->count >= lex->capacity) {
+        if (lex->capacity == 0) {
+            lex->capacity = 256; // Inits with 256 tokens
+        } else {
+            lex->capacity *= 2;
+        }
+        lex->tokens = xrealloc(lex->tokens, lex->capacity*sizeof(Token));
+    }
+    lex->tokens[lex->count++] = t;
+}
+
+Lexer *lex_init(const char *src) {
+    Lexer *lex = xmalloc(sizeof(Lexer));
+    lex->src = src;
+    lex->cursor = src;
+    lex->tokens = NULL;
+    lex->count = 0;
+    lex->capacity = 0;
+    lex->pos = 0;
+
+    // Tokenize all the source, the EOF token is kept as terminator
+    Token t;
+    do {
+        t = lex_scan(lex);
+        lex_push(lex, t);
+    } while (t.type != TOKEN_EOF);
+
+    return lex;
+}
+
+Token lex_next(Lexer *lex) {
+    Token t = lex->tokens[lex->pos];
+
+    // The EOF token is never consumed
+    if (t.type != TOKEN_EOF) {
+        lex->pos++;
+    }
 
     return t;
 }
 
-Lexer *lex_save(const Lexer *lex) {
-    Lexer *state = xmalloc(sizeof(Lexer));
-    state->src = lex->src;
-    state->cursor = lex->cursor;
-    return state;
+Token lex_peek(Lexer *lex) {
+    return lex->tokens[lex->pos];
 }
 
-void lex_restore(Lexer *lex, const Lexer *state) {
-    lex->src = state->src;
-    lex->cursor = state->cursor;
+const Token *lex_tokens(const Lexer *lex, size_t *count) {
+    *count = lex->count;
+    return lex->tokens;
 }
 
 void lex_free(Lexer *lex) {
+    free(lex->tokens);
     free(lex);
 }
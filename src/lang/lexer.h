@@ -49,8 +49,9 @@ typedef struct {
 
 typedef struct Lexer Lexer;
 
-// Construct a new lexer.
-// 'src' must be a string buffer and must be null terminated.
+// Construct a new lexer, the whole source is tokenized here in a single pass.
+// 'src' must be a string buffer and must be null terminated,
+// and it must outlive the lexer (the tokens point into it).
 Lexer *lex_init(const char *src);
 
 // Get next token
@@ -59,11 +60,9 @@ Token lex_next(Lexer *lex);
 // Get next token, without consuming it
 Token lex_peek(Lexer *lex);
 
-// Create a new lexer equal to 'lex'
-Lexer *lex_save(const Lexer *lex);
-
-// Copy the 'state' into 'lex'
-void lex_restore(Lexer *lex, const Lexer *state);
+// Returns the array of all the tokens of the source, the last one is always TOKEN_EOF.
+// 'count' is set to the array length.
+const Token *lex_tokens(const Lexer *lex, size_t *count);
 
 // Free the lexer
 void lex_free(Lexer *lex);
@@ -5,168 +5,157 @@
 #include <stdio.h>
 #include <assert.h>
 
-AST_Node *create_node(enum Node_Type type) {
-    AST_Node *node = xcalloc(1, sizeof(AST_Node));
+AST_Node *create_node(Arena *arena, enum Node_Type type) {
+    AST_Node *node = arena_alloc(arena, sizeof(AST_Node));
     node->type = type;
     return node;
 }
 
-void parser_free_ast_node(AST_Node *node) {
-    if (node != NULL) {
-
-        // Leaf nodes
-        if (node->type == NODE_NUM || node->type == NODE_VAR || node->type == NODE_BOOL_LITERAL) {
-            free(node);
-        }
-        else {
-            parser_free_ast_node(node->as.child.left);
-            parser_free_ast_node(node->as.child.right);
-            parser_free_ast_node(node->as.child.condition);
-            free(node);
+// Item of the printer stack: a node to print or a text to print as it is
+typedef struct {
+    const AST_Node *node;
+    const char *text;
+} Print_Item;
+
+typedef struct {
+    Print_Item *data;
+    size_t count;
+    size_t capacity;
+} Print_Stack;
+
+static void print_stack_push(Print_Stack *s, const AST_Node *node, const char *text) {
+    if (s->count >= s->capacity) {
+        if (s->capacity == 0) {
+            s->capacity = 64;
+        } else {
+            s->capacity *= 2;
         }
+        s->data = xrealloc(s->data, s->capacity*sizeof(Print_Item));
     }
+    s->data[s->count].node = node;
+    s->data[s->count].text = text;
+    s->count++;
 }
 
-static void parser_print_ast_impl(const AST_Node *node, FILE *fp) {
-    switch (node->type) {
-    case NODE_NUM:
-        fprintf(fp, " %ld", node->as.num);
-        break;
-    case NODE_VAR:
-        fprintf(fp, " %.*s", (int)node->as.var.len, node->as.var.name);
-        break;
-    case NODE_BOOL_LITERAL:
-        if (node->as.boolean) {
-            fprintf(fp, " (true)");
-        } else {
-            fprintf(fp, " (false)");
-        }
-        break;
-    case NODE_PLUS:
-        fprintf(fp, " (+");
-        parser_print_ast_impl(node->as.child.left, fp);
-        parser_print_ast_impl(node->as.child.right, fp);
-        fprintf(fp, ")");
-        break;
-    case NODE_MINUS:
-        fprintf(fp, " (-");
-        parser_print_ast_impl(node->as.child.left, fp);
-        parser_print_ast_impl(node->as.child.right, fp);
-        fprintf(fp, ")");
-        break;
-    case NODE_MULT:
-        fprintf(fp, " (*");
-        parser_print_ast_impl(node->as.child.left, fp);
-        parser_print_ast_impl(node->as.child.right, fp);
-        fprintf(fp, ")");
-        break;
-    case NODE_DIV:
-        fprintf(fp, " (/");
-        parser_print_ast_impl(node->as.child.left, fp);
-        parser_print_ast_impl(node->as.child.right, fp);
-        fprintf(fp, ")");
-        break;
-    case NODE_EQ:
-        fprintf(fp, " (=");
-        parser_print_ast_impl(node->as.child.left, fp);
-        parser_print_ast_impl(node->as.child.right, fp);
-        fprintf(fp, ")");
-        break;
-    case NODE_LEQ:
-        fprintf(fp, " (<=");
-        parser_print_ast_impl(node->as.child.left, fp);
-        parser_print_ast_impl(node->as.child.right, fp);
-        fprintf(fp, ")");
-        break;
-    case NODE_NOT:
-        fprintf(fp, " (!");
-        parser_print_ast_impl(node->as.child.left, fp);
-        fprintf(fp, ")");
-        break;
-    case NODE_AND:
-        fprintf(fp, " (&");
-        parser_print_ast_impl(node->as.child.left, fp);
-        parser_print_ast_impl(node->as.child.right, fp);
-        fprintf(fp, ")");
-        break;
-    case NODE_ASSIGN:
-        fprintf(fp, " (:=");
-        parser_print_ast_impl(node->as.child.left, fp);
-        parser_print_ast_impl(node->as.child.right, fp);
-        fprintf(fp, ")");
-        break;
-    case NODE_SKIP:
-        fprintf(fp, " (skip");
-        fprintf(fp, ")");
-        break;
-    case NODE_SEQ:
-        parser_print_ast_impl(node->as.child.left, fp);
-        parser_print_ast_impl(node->as.child.right, fp);
-        break;
-    case NODE_IF:
-        fprintf(fp, " (if");
-        parser_print_ast_impl(node->as.child.condition, fp);
-        fprintf(fp, " (");
-        parser_print_ast_impl(node->as.child.left, fp);
-        parser_print_ast_impl(node->as.child.right, fp);
-        fprintf(fp, "))");
-        break;
-    case NODE_WHILE:
-        fprintf(fp, " (while");
-        parser_print_ast_impl(node->as.child.condition, fp);
-        fprintf(fp, " (");
-        parser_print_ast_impl(node->as.child.left, fp);
-        fprintf(fp, "))");
-        break;
+// Operator printed at the start of the S-expression of the binary nodes
+static const char *binary_symbol(enum Node_Type type) {
+    switch (type) {
+    case NODE_PLUS:   return " (+";
+    case NODE_MINUS:  return " (-";
+    case NODE_MULT:   return " (*";
+    case NODE_DIV:    return " (/";
+    case NODE_EQ:     return " (=";
+    case NODE_LEQ:    return " (<=";
+    case NODE_AND:    return " (&";
+    case NODE_ASSIGN: return " (:=";
     default:
         assert(0 && "UNREACHABLE");
     }
 }
 
+// The children are pushed in reverse order, so they are printed from the left
 void parser_print_ast(const AST_Node *node, FILE *fp) {
-    parser_print_ast_impl(node, fp);
-}
-
-AST_Node *parser_copy_node(const AST_Node *node) {
-    if (node != NULL) {
-
-        // Leaf nodes
-        if (node->type == NODE_NUM || node->type == NODE_VAR || node->type == NODE_BOOL_LITERAL) {
-            AST_Node *node_copy = create_node(node->type);
-
-            if (node->type == NODE_NUM) {
-                node_copy->as.num = node->as.num;
-            }
-            else if (node->type == NODE_VAR) {
-                node_copy->as.var.name = node->as.var.name;
-                node_copy->as.var.len = node->as.var.len;
-            }
-            else if (node->type == NODE_BOOL_LITERAL) {
-                node_copy->as.boolean = node->as.boolean;
-            }
-
-            return node_copy;
+    Print_Stack s = {0};
+    print_stack_push(&s, node, NULL);
+
+    while (s.count > 0) {
+        Print_Item item = s.data[--s.count];
+        if (item.text != NULL) {
+            fprintf(fp, "%s", item.text);
+            continue;
         }
-        else {
-            AST_Node *node_copy = create_node(node->type);
 
-            node_copy->as.child.left = parser_copy_node(node->as.child.left);
-            node_copy->as.child.right = parser_copy_node(node->as.child.right);
-            node_copy->as.child.condition = parser_copy_node(node->as.child.condition);
-
-            return node_copy;
+        node = item.node;
+        switch (node->type) {
+        case NODE_NUM:
+            fprintf(fp, " %ld", node->as.num);
+            break;
+        case NODE_VAR:
+            fprintf(fp, " %.*s", (int)node->as.var.len, node->as.var.name);
+            break;
+        case NODE_BOOL_LITERAL:
+            if (node->as.boolean) {
+                fprintf(fp, " (true)");
+            } else {
+                fprintf(fp, " (false)");
+            }
+            break;
+        case NODE_PLUS:
+        case NODE_MINUS:
+        case NODE_MULT:
+        case NODE_DIV:
+        case NODE_EQ:
+        case NODE_LEQ:
+        case NODE_AND:
+        case NODE_ASSIGN:
+            fprintf(fp, "%s", binary_symbol(node->type));
+            print_stack_push(&s, NULL, ")");
+            print_stack_push(&s, node->as.child.right, NULL);
+            print_stack_push(&s, node->as.child.left, NULL);
+            break;
+        case NODE_NOT:
+            fprintf(fp, " (!");
+            print_stack_push(&s, NULL, ")");
+            print_stack_push(&s, node->as.child.left, NULL);
+            break;
+        case NODE_SKIP:
+            fprintf(fp, " (skip)");
+            break;
+        case NODE_SEQ:
+            print_stack_push(&s, node->as.child.right, NULL);
+            print_stack_push(&s, node->as.child.left, NULL);
+            break;
+        case NODE_IF:
+            fprintf(fp, " (if");
+            print_stack_push(&s, NULL, "))");
+            print_stack_push(&s, node->as.child.right, NULL);
+            print_stack_push(&s, node->as.child.left, NULL);
+            print_stack_push(&s, NULL, " (");
+            print_stack_push(&s, node->as.child.condition, NULL);
+            break;
+        case NODE_WHILE:
+            fprintf(fp, " (while");
+            print_stack_push(&s, NULL, "))");
+            print_stack_push(&s, node->as.child.left, NULL);
+            print_stack_push(&s, NULL, " (");
+            print_stack_push(&s, node->as.child.condition, NULL);
+            break;
+        default:
+            assert(0 && "UNREACHABLE");
         }
     }
 
-    return NULL;
+    free(s.data);
 }
 
-/* ============================= Recursive descent parser ============================= */
-// https://en.wikipedia.org/wiki/Recursive_descent_parser
-
-static AST_Node *parse_stmt(Lexer *lex);
-static AST_Node *parse_bexp(Lexer *lex);
-static AST_Node *parse_aexp(Lexer *lex);
+/* ============================= Parser ============================= */
+// The parser does not recurse: the constructs still open are kept on explicit stacks,
+// so the nesting depth and the length of the program are bounded only by the heap memory.
+//
+// The expressions (Aexp and Bexp together) are parsed with precedence climbing
+// (https://en.wikipedia.org/wiki/Operator-precedence_parser#Precedence_climbing_method)
+// in its shunting yard form, so a parenthesized expression is parsed once and only
+// after that we know if it is an Aexp or a Bexp.
+
+// Parser state
+typedef struct {
+    Lexer *lex;
+    Arena *arena; // The AST nodes are allocated here
+
+    // Expressions: operands and pending operators (binary operators, '(' and '!')
+    AST_Node **operands;
+    size_t operands_count;
+    size_t operands_capacity;
+    enum Token_Type *ops;
+    size_t ops_count;
+    size_t ops_capacity;
+    size_t open_groups; // Number of '(' and '!' in 'ops'
+
+    // Statements: the ';', if and while nodes still waiting for a statement
+    AST_Node **stmts;
+    size_t stmts_count;
+    size_t stmts_capacity;
+} Parser;
 
 static void expect(Token t, enum Token_Type type) {
     if (t.type != type) {
@@ -175,297 +164,337 @@ static void expect(Token t, enum Token_Type type) {
     }
 }
 
-static AST_Node *parse_factor_aexp(Lexer *lex) {
-    Token t = lex_next(lex);
-
-    // OPAR
-    if (t.type == TOKEN_OPAR) {
-        AST_Node *node = parse_aexp(lex);
-        expect(lex_next(lex), TOKEN_CPAR);
-        return node;
-    }
-
-    // Numeral
-    if (t.type == TOKEN_NUM) {
-        AST_Node *num_node = create_node(NODE_NUM);
-        num_node->as.num = t.as.num;
-
-        return num_node;
-    }
-
-    // Variable
-    if (t.type == TOKEN_VAR) {
-        AST_Node *var_node = create_node(NODE_VAR);
-        var_node->as.var.name = t.as.str.name;
-        var_node->as.var.len = t.as.str.len;
-
-        return var_node;
+static void node_stack_push(AST_Node ***data, size_t *count, size_t *capacity, AST_Node *node) {
+    if (*count >= *capacity) {
+        if (*capacity == 0) {
+            *capacity = 64;
+        } else {
+            *capacity *= 2;
+        }
+        *data = xrealloc(*data, *capacity*sizeof(AST_Node *));
     }
-
-    fprintf(stderr, "[ERROR]: Unexpected token while parsing aexp\n");
-    exit(1);
+    (*data)[(*count)++] = node;
 }
 
-static AST_Node *parse_term_aexp(Lexer *lex) {
-    AST_Node *left = parse_factor_aexp(lex);
-
-    // '*' and '/' precedence
-    Token t = lex_peek(lex);
-    while (t.type == TOKEN_MULT || t.type == TOKEN_DIV) {
-        lex_next(lex);
-
-        AST_Node *node = NULL;
-        if (t.type == TOKEN_MULT) {
-            node = create_node(NODE_MULT);
+static void op_push(Parser *p, enum Token_Type type) {
+    if (p->ops_count >= p->ops_capacity) {
+        if (p->ops_capacity == 0) {
+            p->ops_capacity = 64;
         } else {
-            node = create_node(NODE_DIV);
+            p->ops_capacity *= 2;
         }
-
-        node->as.child.left = left;
-        node->as.child.right = parse_factor_aexp(lex);
-        left = node;
-
-        t = lex_peek(lex);
+        p->ops = xrealloc(p->ops, p->ops_capacity*sizeof(enum Token_Type));
     }
-
-    return left;
+    p->ops[p->ops_count++] = type;
 }
 
-static AST_Node *parse_aexp(Lexer *lex) {
-    AST_Node *left = parse_term_aexp(lex);
-
-    // '-' and '+' precedence
-    Token t = lex_peek(lex);
-    while (t.type == TOKEN_PLUS || t.type == TOKEN_MINUS) {
-        lex_next(lex);
-
-        AST_Node *node = NULL;
-        if (t.type == TOKEN_PLUS) {
-            node = create_node(NODE_PLUS);
-        } else {
-            node = create_node(NODE_MINUS);
-        }
+static bool is_aexp(const AST_Node *node) {
+    switch (node->type) {
+    case NODE_NUM:
+    case NODE_VAR:
+    case NODE_PLUS:
+    case NODE_MINUS:
+    case NODE_MULT:
+    case NODE_DIV:
+        return true;
+    default:
+        return false;
+    }
+}
 
-        node->as.child.left = left;
-        node->as.child.right = parse_term_aexp(lex);
-        left = node;
+static void check_aexp(const AST_Node *node) {
+    if (!is_aexp(node)) {
+        fprintf(stderr, "[ERROR]: Unexpected token while parsing aexp\n");
+        exit(1);
+    }
+}
 
-        t = lex_peek(lex);
+static void check_bexp(const AST_Node *node) {
+    if (is_aexp(node)) {
+        fprintf(stderr, "[ERROR]: Unexpected token while parsing bexp\n");
+        exit(1);
     }
+}
 
-    return left;
+// Binary operators precedence (0 if the token is not a binary operator):
+//     '*' '/'  >  '+' '-'  >  '=' '<='  >  '&'
+#define PREC_AND 1
+#define PREC_CMP 2
+#define PREC_SUM 3
+#define PREC_MUL 4
+
+static int binary_precedence(enum Token_Type type) {
+    switch (type) {
+    case TOKEN_AND:   return PREC_AND;
+    case TOKEN_EQ:
+    case TOKEN_LEQ:   return PREC_CMP;
+    case TOKEN_PLUS:
+    case TOKEN_MINUS: return PREC_SUM;
+    case TOKEN_MULT:
+    case TOKEN_DIV:   return PREC_MUL;
+    default:          return 0;
+    }
 }
 
-static AST_Node *parse_atom_bexp(Lexer *lex) {
-    Token t = lex_peek(lex);
+static enum Node_Type binary_node_type(enum Token_Type type) {
+    switch (type) {
+    case TOKEN_AND:   return NODE_AND;
+    case TOKEN_EQ:    return NODE_EQ;
+    case TOKEN_LEQ:   return NODE_LEQ;
+    case TOKEN_PLUS:  return NODE_PLUS;
+    case TOKEN_MINUS: return NODE_MINUS;
+    case TOKEN_MULT:  return NODE_MULT;
+    case TOKEN_DIV:   return NODE_DIV;
+    default:
+        assert(0 && "UNREACHABLE");
+    }
+}
 
-    // OPAR
-    if (t.type == TOKEN_OPAR) {
+static AST_Node *parse_leaf(Parser *p, Token t) {
+    // Numeral
+    if (t.type == TOKEN_NUM) {
+        AST_Node *num_node = create_node(p->arena, NODE_NUM);
+        num_node->as.num = t.as.num;
 
-        // Save the lexer state
-        Lexer *state = lex_save(lex);
-        lex_next(lex);
+        return num_node;
+    }
 
-        AST_Node *node = parse_bexp(lex);
-        if (node != NULL) {
-            expect(lex_next(lex), TOKEN_CPAR);
-            return node;
-        }
+    // Variable
+    if (t.type == TOKEN_VAR) {
+        AST_Node *var_node = create_node(p->arena, NODE_VAR);
+        var_node->as.var.name = t.as.str.name;
+        var_node->as.var.len = t.as.str.len;
 
-        // The expr is not a bexpr so it must be an aexpr,
-        // restore and fall through to reach the EQ/LEQ cases
-        lex_restore(lex, state);
-        lex_free(state);
+        return var_node;
     }
 
     // True
     if (t.type == TOKEN_TRUE) {
-        lex_next(lex);
-        AST_Node *bool_lit_node = create_node(NODE_BOOL_LITERAL);
+        AST_Node *bool_lit_node = create_node(p->arena, NODE_BOOL_LITERAL);
         bool_lit_node->as.boolean = true;
         return bool_lit_node;
     }
 
     // False
     if (t.type == TOKEN_FALSE) {
-        lex_next(lex);
-        AST_Node *bool_lit_node = create_node(NODE_BOOL_LITERAL);
+        AST_Node *bool_lit_node = create_node(p->arena, NODE_BOOL_LITERAL);
         bool_lit_node->as.boolean = false;
         return bool_lit_node;
     }
 
-    // Not
-    if (t.type == TOKEN_NOT) {
-        lex_next(lex);
-        AST_Node *not_node = create_node(NODE_NOT);
-        not_node->as.child.left = parse_bexp(lex);
-        if (not_node->as.child.left == NULL) return NULL;
-        return not_node;
-    }
+    fprintf(stderr, "[ERROR]: Unexpected token while parsing expr\n");
+    exit(1);
+}
 
-    // It can be EQ or LEQ
-    AST_Node *left = parse_aexp(lex);
-    t = lex_next(lex);
+// Build the nodes of the pending binary operators with precedence at least 'min_prec'
+// (they are left associative, so the ones with the same precedence are built first)
+static void reduce_ops(Parser *p, int min_prec) {
+    while (p->ops_count > 0 && binary_precedence(p->ops[p->ops_count - 1]) >= min_prec) {
+        int prec = binary_precedence(p->ops[p->ops_count - 1]);
 
-    // EQ
-    if (t.type == TOKEN_EQ) {
-        AST_Node *eq_node = create_node(NODE_EQ);
-        eq_node->as.child.left = left;
-        eq_node->as.child.right = parse_aexp(lex);
-        return eq_node;
-    }
+        AST_Node *node = create_node(p->arena, binary_node_type(p->ops[--p->ops_count]));
+        node->as.child.right = p->operands[--p->operands_count];
+        node->as.child.left = p->operands[--p->operands_count];
 
-    // LEQ
-    if (t.type == TOKEN_LEQ) {
-        AST_Node *leq_node = create_node(NODE_LEQ);
-        leq_node->as.child.left = left;
-        leq_node->as.child.right = parse_aexp(lex);
-        return leq_node;
-    }
+        // Check the operands
+        if (prec == PREC_AND) {
+            check_bexp(node->as.child.left);
+            check_bexp(node->as.child.right);
+        } else {
+            check_aexp(node->as.child.left);
+            check_aexp(node->as.child.right);
+        }
 
-    // Here we return NULL instead of exit because with the bexp parentheses
-    // parsing we can fail and we need to try to parse an aexp instead (OPAR case)
-    return NULL;
+        node_stack_push(&p->operands, &p->operands_count, &p->operands_capacity, node);
+    }
 }
 
-static AST_Node *parse_bexp(Lexer *lex) {
-    AST_Node *left = parse_atom_bexp(lex);
-    if (left == NULL) return NULL;
-
-    Token t = lex_peek(lex);
-    while (t.type == TOKEN_AND) {
-        lex_next(lex);
-
-        AST_Node *and_node = create_node(NODE_AND);
-        and_node->as.child.left = left;
-        and_node->as.child.right = parse_atom_bexp(lex);
-        if (and_node->as.child.right == NULL) return NULL;
+// Parse an expression with binary operators of precedence at least 'min_prec'
+// (inside '(' and '!' all the operators are allowed again).
+//
+// A '(' or a '!' opens a group that is closed by the first token that can not continue it:
+// the ')' for the parenthesis, anything but a binary operator for the not,
+// so it negates all the following Bexp ('!b1 & b2' is '!(b1 & b2)').
+static AST_Node *parse_expr(Parser *p, int min_prec) {
+    for (;;) {
+        // Operand, after the groups that it opens
+        Token t = lex_next(p->lex);
+        while (t.type == TOKEN_OPAR || t.type == TOKEN_NOT) {
+            op_push(p, t.type);
+            p->open_groups++;
+            t = lex_next(p->lex);
+        }
+        node_stack_push(&p->operands, &p->operands_count, &p->operands_capacity, parse_leaf(p, t));
+
+        // Operator, after the groups that are closed before it
+        for (;;) {
+            t = lex_peek(p->lex);
+            int prec = binary_precedence(t.type);
+            if (prec != 0 && (p->open_groups > 0 || prec >= min_prec)) {
+                lex_next(p->lex);
+                reduce_ops(p, prec);
+                op_push(p, t.type);
+                break;
+            }
 
-        left = and_node;
+            reduce_ops(p, PREC_AND);
+            if (p->open_groups == 0) {
+                return p->operands[--p->operands_count];
+            }
 
-        t = lex_peek(lex);
+            p->open_groups--;
+            if (p->ops[--p->ops_count] == TOKEN_OPAR) {
+                expect(lex_next(p->lex), TOKEN_CPAR);
+            } else {
+                AST_Node *not_node = create_node(p->arena, NODE_NOT);
+                not_node->as.child.left = p->operands[p->operands_count - 1];
+                check_bexp(not_node->as.child.left);
+                p->operands[p->operands_count - 1] = not_node;
+            }
+        }
     }
-
-    return left;
 }
 
-static void check_bexp_parsing_error(const AST_Node *node) {
-    if (node == NULL) {
-        fprintf(stderr, "[ERROR]: Unexpected token while parsing bexp\n");
-        exit(1);
-    }
+static AST_Node *parse_aexp(Parser *p) {
+    AST_Node *node = parse_expr(p, PREC_SUM);
+    check_aexp(node);
+    return node;
 }
 
-static AST_Node *parse_atom_stmt(Lexer *lex) {
-    Token t = lex_next(lex);
+static AST_Node *parse_bexp(Parser *p) {
+    AST_Node *node = parse_expr(p, PREC_AND);
+    check_bexp(node);
+    return node;
+}
 
+// Parse the statements that are not an if or a while, 't' is their first token
+static AST_Node *parse_atom_stmt(Parser *p, Token t) {
     // Assignment
     if (t.type == TOKEN_VAR) {
 
         // Variable (a)
-        AST_Node *var_node = create_node(NODE_VAR);
+        AST_Node *var_node = create_node(p->arena, NODE_VAR);
         var_node->as.var.name = t.as.str.name;
         var_node->as.var.len = t.as.str.len;
 
         // Assing symbol (:=)
-        t = lex_next(lex);
+        t = lex_next(p->lex);
         expect(t, TOKEN_ASSIGN);
 
         // Aexp
-        AST_Node *assign_node = create_node(NODE_ASSIGN);
+        AST_Node *assign_node = create_node(p->arena, NODE_ASSIGN);
         assign_node->as.child.left = var_node;
-        assign_node->as.child.right = parse_aexp(lex);
+        assign_node->as.child.right = parse_aexp(p);
 
         return assign_node;
     }
 
     // Skip
     if (t.type == TOKEN_SKIP) {
-        AST_Node *skip_node = create_node(NODE_SKIP);
+        AST_Node *skip_node = create_node(p->arena, NODE_SKIP);
         return skip_node;
     }
 
-    // If stmt
-    if (t.type == TOKEN_IF) {
-        AST_Node *if_node = create_node(NODE_IF);
-
-        // Condition (b)
-        if_node->as.child.condition = parse_bexp(lex);
-        check_bexp_parsing_error(if_node->as.child.condition);
-
-        // Then symbol
-        t = lex_next(lex);
-        expect(t, TOKEN_THEN);
+    fprintf(stderr, "[ERROR]: Unexpected token while parsing stmt\n");
+    exit(1);
+}
 
-        // S1
-        if_node->as.child.left = parse_stmt(lex);
+// Parse the sequence statements.
+// The if and while are pushed on the stack after their header, and a statement is
+// pushed as a ';' node when it is followed by another one. When a statement ends,
+// the ';' nodes on the top are completed (S1;S2 is right associative),
+// and then the construct below it gets its next part.
+static AST_Node *parse_stmt(Parser *p) {
+    for (;;) {
+        Token t = lex_next(p->lex);
+
+        // If stmt, up to the then symbol
+        if (t.type == TOKEN_IF) {
+            AST_Node *if_node = create_node(p->arena, NODE_IF);
+            if_node->as.child.condition = parse_bexp(p);
+            expect(lex_next(p->lex), TOKEN_THEN);
+
+            node_stack_push(&p->stmts, &p->stmts_count, &p->stmts_capacity, if_node);
+            continue;
+        }
 
-        // Else symbol
-        t = lex_next(lex);
-        expect(t, TOKEN_ELSE);
+        // While stmt, up to the do symbol
+        if (t.type == TOKEN_WHILE) {
+            AST_Node *while_node = create_node(p->arena, NODE_WHILE);
+            while_node->as.child.condition = parse_bexp(p);
+            expect(lex_next(p->lex), TOKEN_DO);
 
-        // S2
-        if_node->as.child.right = parse_stmt(lex);
+            node_stack_push(&p->stmts, &p->stmts_count, &p->stmts_capacity, while_node);
+            continue;
+        }
 
-        // Fi symbol
-        t = lex_next(lex);
-        expect(t, TOKEN_FI);
+        AST_Node *node = parse_atom_stmt(p, t);
 
-        return if_node;
-    }
+        // Complete the constructs closed after 'node', until one needs another statement
+        for (;;) {
+            if (lex_peek(p->lex).type == TOKEN_SEMICOL) {
+                lex_next(p->lex);
+                AST_Node *seq_node = create_node(p->arena, NODE_SEQ);
+                seq_node->as.child.left = node;
 
-    // While stmt
-    if (t.type == TOKEN_WHILE) {
-        AST_Node *while_node = create_node(NODE_WHILE);
+                node_stack_push(&p->stmts, &p->stmts_count, &p->stmts_capacity, seq_node);
+                break;
+            }
 
-        // Condition (b)
-        while_node->as.child.condition = parse_bexp(lex);
-        check_bexp_parsing_error(while_node->as.child.condition);
+            while (p->stmts_count > 0 && p->stmts[p->stmts_count - 1]->type == NODE_SEQ) {
+                AST_Node *seq_node = p->stmts[--p->stmts_count];
+                seq_node->as.child.right = node;
+                node = seq_node;
+            }
 
-        // Do symbol
-        t = lex_next(lex);
-        expect(t, TOKEN_DO);
+            if (p->stmts_count == 0) {
+                return node;
+            }
 
-        // S
-        while_node->as.child.left = parse_stmt(lex);
+            AST_Node *top = p->stmts[p->stmts_count - 1];
+            if (top->type == NODE_IF && top->as.child.left == NULL) {
+                // S1, the else branch follows
+                top->as.child.left = node;
+                expect(lex_next(p->lex), TOKEN_ELSE);
+                break;
+            }
 
-        // Done symbol
-        t = lex_next(lex);
-        expect(t, TOKEN_DONE);
+            if (top->type == NODE_IF) {
+                // S2
+                top->as.child.right = node;
+                expect(lex_next(p->lex), TOKEN_FI);
+            } else {
+                // While body
+                top->as.child.left = node;
+                expect(lex_next(p->lex), TOKEN_DONE);
+            }
 
-        return while_node;
+            p->stmts_count--;
+            node = top;
+        }
     }
-
-    fprintf(stderr, "[ERROR]: Unexpected token while parsing stmt\n");
-    exit(1);
 }
 
-// Parse the sequence statements
-static AST_Node *parse_stmt(Lexer *lex) {
-    AST_Node *left = parse_atom_stmt(lex);
-
-    Token t = lex_peek(lex);
-    if (t.type == TOKEN_SEMICOL) {
-        lex_next(lex);
-        AST_Node *node = create_node(NODE_SEQ);
-        node->as.child.left = left;
-        node->as.child.right = parse_stmt(lex);
-        return node;
-    }
+AST_Node *parser_parse(Lexer *lex, Arena *arena) {
+    Parser parser = {
+        .lex = lex,
+        .arena = arena,
+    };
+    Parser *p = &parser;
 
-    return left;
-}
-
-AST_Node *parser_parse(Lexer *lex) {
-    AST_Node *root = parse_stmt(lex);
+    AST_Node *root = parse_stmt(p);
 
     // Check if we reached the end
-    Token t = lex_peek(lex);
+    Token t = lex_peek(p->lex);
     if (t.type != TOKEN_EOF) {
         fprintf(stderr, "[ERROR]: Expected end of file, but found token of type %d\n", t.type);
         exit(1);
     }
 
+    free(p->operands);
+    free(p->ops);
+    free(p->stmts);
+
     return root;
 }
 
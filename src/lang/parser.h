@@ -70,26 +70,24 @@ struct AST_Node {
         } child;
 
         // Leaf node attributes
-        String var;
+        struct {
+            const char *name;
+            size_t len;
+            size_t slot; // Index of the variable in the program variables, resolved when the CFG is built
+        } var;
         int64_t num;
         bool boolean;
     } as;
 };
 
 // Parse the program according to the grammar.
-// Returns the root node of the AST.
-AST_Node *parser_parse(Lexer *lex);
+// Returns the root node of the AST, all the nodes are allocated in 'arena'.
+AST_Node *parser_parse(Lexer *lex, Arena *arena);
 
 // Prints the ast through 'fp' (as S-expression)
 void parser_print_ast(const AST_Node *node, FILE *fp);
 
-// Allocate a zero initialized AST node
-AST_Node *create_node(enum Node_Type type);
-
-// Returns an dynamic allocated copy of the tree in 'node'
-AST_Node *parser_copy_node(const AST_Node *node);
-
-// Free the AST node subtree
-void parser_free_ast_node(AST_Node *node);
+// Allocate a zero initialized AST node in 'arena'
+AST_Node *create_node(Arena *arena, enum Node_Type type);
 
 #endif // WHILE_AI_PARSER_
@@ -0,0 +1,180 @@
+#include "scc.h"
+#include "../common.h"
+#include <stdlib.h>
+#include <stdbool.h>
+
+// Frame of the depth first visit of 'v', 'edge' is the next successor to explore
+typedef struct {
+    size_t v;
+    size_t edge;
+} SCC_Frame;
+
+// Tarjan's algorithm from P0, with the calls on an explicit stack.
+// The components are found in reverse topological order (a component is closed
+// after all the components reachable from it), 'component' is filled with that order.
+// Returns the number of components.
+static size_t scc_tarjan(const CFG *cfg, size_t *component) {
+    // Depth First Number of each node (0 means not yet visited) and the smallest one it reaches
+    size_t *index = xcalloc(cfg->count, sizeof(size_t));
+    size_t *low = xmalloc(sizeof(size_t) * cfg->count);
+    bool *on_stack = xcalloc(cfg->count, sizeof(bool));
+    size_t num = 0;
+
+    // Stack of the visited nodes not yet assigned to a component
+    size_t *stack = xmalloc(sizeof(size_t) * cfg->count);
+    size_t stack_count = 0;
+
+    // Call stack of the visit
+    SCC_Frame *frames = xmalloc(sizeof(SCC_Frame) * cfg->count);
+    size_t frames_count = 0;
+
+    size_t count = 0;
+    for (size_t i = 0; i < cfg->count; ++i) {
+        component[i] = SIZE_MAX;
+    }
+
+    index[0] = low[0] = ++num;
+    stack[stack_count++] = 0;
+    on_stack[0] = true;
+    frames[frames_count++] = (SCC_Frame) { .v = 0, .edge = 0 };
+
+    while (frames_count > 0) {
+        SCC_Frame *frame = &frames[frames_count - 1];
+        size_t v = frame->v;
+        const CFG_Node *node = &cfg->nodes[v];
+
+        if (frame->edge < node->edge_count) {
+            size_t w = node->edges[frame->edge++].dst;
+            if (index[w] == 0) {
+                index[w] = low[w] = ++num;
+                stack[stack_count++] = w;
+                on_stack[w] = true;
+                frames[frames_count++] = (SCC_Frame) { .v = w, .edge = 0 };
+            } else if (on_stack[w] && index[w] < low[v]) {
+                low[v] = index[w];
+            }
+            continue;
+        }
+
+        // All the successors are explored, 'v' closes a component if it is its root
+        frames_count--;
+        if (low[v] == index[v]) {
+            size_t w;
+            do {
+                w = stack[--stack_count];
+                on_stack[w] = false;
+                component[w] = count;
+            } while (w != v);
+            count++;
+        }
+
+        if (frames_count > 0) {
+            size_t parent = frames[frames_count - 1].v;
+            if (low[v] < low[parent]) {
+                low[parent] = low[v];
+            }
+        }
+    }
+
+    free(index);
+    free(low);
+    free(on_stack);
+    free(stack);
+    free(frames);
+
+    return count;
+}
+
+SCC *scc_get(const CFG *cfg) {
+    SCC *scc = xmalloc(sizeof(SCC));
+    scc->component = xmalloc(sizeof(size_t) * cfg->count);
+    scc->count = scc_tarjan(cfg, scc->component);
+
+    // Reverse the numbering, so it follows the topological order
+    for (size_t i = 0; i < cfg->count; ++i) {
+        if (scc->component[i] != SIZE_MAX) {
+            scc->component[i] = scc->count - 1 - scc->component[i];
+        }
+    }
+
+    // Nodes of each component (counting sort on the component)
+    scc->node_start = xcalloc(scc->count + 1, sizeof(size_t));
+    for (size_t i = 0; i < cfg->count; ++i) {
+        if (scc->component[i] != SIZE_MAX) {
+            scc->node_start[scc->component[i] + 1]++;
+        }
+    }
+    scc->max_size = 0;
+    for (size_t c = 0; c < scc->count; ++c) {
+        if (scc->node_start[c + 1] > scc->max_size) {
+            scc->max_size = scc->node_start[c + 1];
+        }
+        scc->node_start[c + 1] += scc->node_start[c];
+    }
+
+    scc->nodes = xmalloc(sizeof(size_t) * (scc->node_start[scc->count] + 1));
+    size_t *next = xmalloc(sizeof(size_t) * (scc->count + 1));
+    for (size_t c = 0; c < scc->count; ++c) {
+        next[c] = scc->node_start[c];
+    }
+    for (size_t i = 0; i < cfg->count; ++i) {
+        if (scc->component[i] != SIZE_MAX) {
+            scc->nodes[next[scc->component[i]]++] = i;
+        }
+    }
+    free(next);
+
+    // Successor components, 'mark[d] == c + 1' when d is already a successor of c.
+    // The first pass counts them and the second one fills them.
+    size_t *mark = xcalloc(scc->count + 1, sizeof(size_t));
+    scc->succ_start = xcalloc(scc->count + 1, sizeof(size_t));
+    scc->pred_count = xcalloc(scc->count + 1, sizeof(size_t));
+    scc->succ = NULL;
+
+    for (size_t pass = 0; pass < 2; ++pass) {
+        size_t succ_count = 0;
+        for (size_t c = 0; c < scc->count; ++c) {
+            if (pass == 0) {
+                scc->succ_start[c] = succ_count;
+            }
+
+            for (size_t k = scc->node_start[c]; k < scc->node_start[c + 1]; ++k) {
+                const CFG_Node *node = &cfg->nodes[scc->nodes[k]];
+                for (size_t e = 0; e < node->edge_count; ++e) {
+                    size_t d = scc->component[node->edges[e].dst];
+                    if (d == c || mark[d] == c + 1) {
+                        continue;
+                    }
+                    mark[d] = c + 1;
+
+                    if (pass == 1) {
+                        scc->succ[succ_count] = d;
+                        scc->pred_count[d]++;
+                    }
+                    succ_count++;
+                }
+            }
+        }
+
+        if (pass == 0) {
+            scc->succ_start[scc->count] = succ_count;
+            scc->succ = xmalloc(sizeof(size_t) * (succ_count + 1));
+            for (size_t c = 0; c < scc->count; ++c) {
+                mark[c] = 0;
+            }
+        }
+    }
+    free(mark);
+
+    return scc;
+}
+
+void scc_free(SCC *scc) {
+    free(scc->component);
+    free(scc->node_start);
+    free(scc->nodes);
+    free(scc->succ_start);
+    free(scc->succ);
+    free(scc->pred_count);
+    free(scc);
+}
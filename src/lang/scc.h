@@ -0,0 +1,38 @@
+#ifndef WHILE_AI_SCC_
+#define WHILE_AI_SCC_
+
+#include "cfg.h"
+#include <stddef.h>
+
+// Strongly Connected Components of the CFG nodes reachable from the entry point (P0),
+// computed with Tarjan's algorithm, and their condensation (the DAG of the components).
+//
+// The components are numbered in topological order, so every edge between two
+// components goes from a smaller number to a bigger one (the component of P0 is 0).
+//
+// 'component[v]' is the component of the node v (SIZE_MAX if v is not reachable).
+// The nodes of the component c are 'nodes[node_start[c] .. node_start[c+1]-1]',
+// its successor components (without duplicates) are 'succ[succ_start[c] .. succ_start[c+1]-1]'
+// and 'pred_count[c]' is the number of its predecessor components.
+typedef struct {
+    size_t count;
+    size_t *component;
+
+    size_t *node_start;
+    size_t *nodes;
+
+    size_t *succ_start;
+    size_t *succ;
+    size_t *pred_count;
+
+    // Number of nodes of the biggest component
+    size_t max_size;
+} SCC;
+
+// Compute the components of the nodes reachable from P0
+SCC *scc_get(const CFG *cfg);
+
+// Free the components
+void scc_free(SCC *scc);
+
+#endif // WHILE_AI_SCC_
@@ -0,0 +1,200 @@
+#include "wto.h"
+#include "../common.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Depth First Number used for the nodes already placed in the WTO
+#define DFN_DONE SIZE_MAX
+
+// Frame of the depth first visit of 'v', 'edge' is the next successor to explore
+typedef struct {
+    size_t v;
+    size_t edge;
+
+    // Smallest Depth First Number reached from 'v', and if it closes a loop
+    size_t head;
+    bool loop;
+
+    // The visit is done and the component headed by 'v' is being built,
+    // its elements are prepended before 'order[end]'
+    bool component;
+    size_t end;
+} WTO_Frame;
+
+typedef struct {
+    const CFG *cfg;
+    WTO *wto;
+
+    // Depth First Number of each node, 0 means not yet visited
+    size_t *dfn;
+    size_t num;
+
+    // Stack of the visited nodes
+    size_t *stack;
+    size_t stack_count;
+
+    // Call stack of the visit, a node has at most one frame at a time
+    WTO_Frame *frames;
+    size_t frames_count;
+
+    // The WTO is built from right to left, new elements are written at 'order[next - 1]'
+    size_t next;
+} WTO_Builder;
+
+static void wto_prepend(WTO_Builder *b, size_t v, size_t component_end) {
+    b->next--;
+    b->wto->order[b->next] = v;
+    b->wto->component_end[b->next] = component_end;
+}
+
+static void wto_visit_begin(WTO_Builder *b, size_t v) {
+    b->stack[b->stack_count++] = v;
+    b->dfn[v] = ++b->num;
+
+    WTO_Frame frame = {
+        .v = v,
+        .edge = 0,
+        .head = b->dfn[v],
+        .loop = false,
+        .component = false,
+        .end = 0,
+    };
+    b->frames[b->frames_count++] = frame;
+}
+
+static void wto_frame_reach(WTO_Frame *frame, size_t min) {
+    if (min <= frame->head) {
+        frame->head = min;
+        frame->loop = true;
+    }
+}
+
+// Visit the nodes reachable from 'root', it is the recursive algorithm of the paper
+// with the calls on an explicit stack (the depth of the visit grows with the program length).
+//
+// A visit returns the smallest Depth First Number reachable from its node without going
+// through a node already placed in the WTO. When all the successors of 'v' are explored
+// and 'v' is the head of a loop, the nodes of the loop are unvisited and then visited
+// again from 'v' for building its component.
+static void wto_visit(WTO_Builder *b, size_t root) {
+    wto_visit_begin(b, root);
+
+    // Value returned by the last visit that ended, if the frame below is waiting for it
+    bool returned = false;
+    size_t ret = 0;
+
+    while (b->frames_count > 0) {
+        WTO_Frame *frame = &b->frames[b->frames_count - 1];
+        const size_t v = frame->v;
+        const CFG_Node *node = &b->cfg->nodes[v];
+
+        if (frame->component) {
+            // The elements of the component are not used for its head
+            returned = false;
+
+            size_t w = SIZE_MAX;
+            while (frame->edge < node->edge_count && w == SIZE_MAX) {
+                size_t dst = node->edges[frame->edge++].dst;
+                if (b->dfn[dst] == 0) {
+                    w = dst;
+                }
+            }
+            if (w != SIZE_MAX) {
+                wto_visit_begin(b, w);
+                continue;
+            }
+
+            wto_prepend(b, v, frame->end);
+            ret = frame->head;
+            returned = true;
+            b->frames_count--;
+            continue;
+        }
+
+        if (returned) {
+            wto_frame_reach(frame, ret);
+            frame->edge++;
+            returned = false;
+        }
+
+        while (frame->edge < node->edge_count) {
+            size_t w = node->edges[frame->edge].dst;
+            if (b->dfn[w] == 0) {
+                break;
+            }
+            wto_frame_reach(frame, b->dfn[w]);
+            frame->edge++;
+        }
+        if (frame->edge < node->edge_count) {
+            wto_visit_begin(b, node->edges[frame->edge].dst);
+            continue;
+        }
+
+        if (frame->head == b->dfn[v]) {
+            b->dfn[v] = DFN_DONE;
+            size_t element = b->stack[--b->stack_count];
+
+            if (frame->loop) {
+                // The nodes of the loop will be visited again while building the component
+                while (element != v) {
+                    b->dfn[element] = 0;
+                    element = b->stack[--b->stack_count];
+                }
+                frame->component = true;
+                frame->edge = 0;
+                frame->end = b->next;
+                continue;
+            }
+
+            wto_prepend(b, v, 0);
+        }
+
+        ret = frame->head;
+        returned = true;
+        b->frames_count--;
+    }
+}
+
+WTO *wto_get(const CFG *cfg) {
+    WTO *wto = xmalloc(sizeof(WTO));
+    wto->order = xmalloc(sizeof(size_t) * cfg->count);
+    wto->component_end = xmalloc(sizeof(size_t) * cfg->count);
+
+    WTO_Builder b = {
+        .cfg = cfg,
+        .wto = wto,
+        .dfn = xcalloc(cfg->count, sizeof(size_t)),
+        .num = 0,
+        .stack = xmalloc(sizeof(size_t) * cfg->count),
+        .stack_count = 0,
+        .frames = xmalloc(sizeof(WTO_Frame) * cfg->count),
+        .frames_count = 0,
+        .next = cfg->count,
+    };
+
+    wto_visit(&b, 0);
+
+    // Unreachable nodes are not in the WTO, so the sequence can start after 'order[0]'
+    wto->count = cfg->count - b.next;
+    if (b.next != 0) {
+        memmove(wto->order, wto->order + b.next, sizeof(size_t) * wto->count);
+        memmove(wto->component_end, wto->component_end + b.next, sizeof(size_t) * wto->count);
+        for (size_t i = 0; i < wto->count; ++i) {
+            if (wto->component_end[i] != 0) {
+                wto->component_end[i] -= b.next;
+            }
+        }
+    }
+
+    free(b.dfn);
+    free(b.stack);
+    free(b.frames);
+
+    return wto;
+}
+
+void wto_free(WTO *wto) {
+    free(wto->order);
+    free(wto->component_end);
+    free(wto);
+}
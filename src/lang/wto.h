@@ -0,0 +1,31 @@
+#ifndef WHILE_AI_WTO_
+#define WHILE_AI_WTO_
+
+#include "cfg.h"
+#include <stddef.h>
+
+// Weak Topological Ordering of the CFG nodes, computed with the algorithm described in
+// "Efficient chaotic iteration strategies with widenings" (F. Bourdoncle, 1993).
+//
+// A WTO is a well-parenthesized sequence of program points, for example:
+//     0 1 (2 3 (4 5) 6) 7
+// where every parenthesized sub-sequence is a component and its first element is the head.
+// Every loop of the CFG contains the head of at least one component,
+// so the heads are a valid set of widening points.
+//
+// The hierarchy is stored flattened: 'order[i]' is the i-th program point of the sequence
+// and 'component_end[i]' is the position just after the component headed by 'order[i]',
+// or 0 if 'order[i]' is not a component head.
+typedef struct {
+    size_t count;
+    size_t *order;
+    size_t *component_end;
+} WTO;
+
+// Compute the WTO of the nodes reachable from the entry point (P0)
+WTO *wto_get(const CFG *cfg);
+
+// Free the WTO
+void wto_free(WTO *wto);
+
+#endif // WHILE_AI_WTO_
@@ -0,0 +1,115 @@
+// mmap, fstat and MAP_ANONYMOUS are not part of C99
+#define _DEFAULT_SOURCE
+
+#include "source.h"
+#include "common.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+
+// Read all the stream in a heap buffer (for the inputs that can't be mapped)
+static Source source_read(FILE *fp, const char *path) {
+    char *text = NULL;
+    size_t len = 0;
+    size_t capacity = 0;
+
+    for (;;) {
+        // One byte always left for the terminator
+        if (len + 1 >= capacity) {
+            capacity = capacity == 0 ? 4096 : capacity * 2;
+            text = xrealloc(text, capacity);
+        }
+
+        size_t n = fread(text + len, 1, capacity - len - 1, fp);
+        len += n;
+
+        if (n == 0) {
+            if (ferror(fp)) {
+                fprintf(stderr, "[ERROR]: Can not read %s.\n", path);
+                exit(1);
+            }
+            break;
+        }
+    }
+    text[len] = '\0';
+
+    return (Source) { .text = text, .len = len, .map_size = 0 };
+}
+
+// Map the regular file 'fd' of 'len' bytes (not 0).
+//
+// The mapping is followed by at least one zero byte for the terminator:
+// first an anonymous (zero filled) region of one page more than the file is reserved,
+// then the file is mapped over its beginning.
+// The rest of the last page of the file is zero filled as well.
+static Source source_map(int fd, size_t len, const char *path) {
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t map_size = (len / page + 1) * page;
+
+    char *text = mmap(NULL, map_size, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (text == MAP_FAILED || mmap(text, len, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+        fprintf(stderr, "[ERROR]: Can not map %s.\n", path);
+        exit(1);
+    }
+
+    // The lexer reads the source once from the start
+    posix_madvise(text, len, POSIX_MADV_SEQUENTIAL);
+
+    return (Source) { .text = text, .len = len, .map_size = map_size };
+}
+
+Source source_open(const char *path) {
+    if (strcmp(path, "-") == 0) {
+        return source_read(stdin, "the standard input");
+    }
+
+    int fd = open(path, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        fprintf(stderr, "[ERROR]: File %s not found.\n", path);
+        exit(1);
+    }
+
+    if ((uintmax_t)st.st_size >= SIZE_MAX) {
+        fprintf(stderr, "[ERROR]: File %s is too big.\n", path);
+        exit(1);
+    }
+
+    Source src;
+    if (S_ISREG(st.st_mode) && st.st_size > 0) {
+        // The mapping stays valid after closing the file
+        src = source_map(fd, (size_t)st.st_size, path);
+        close(fd);
+    } else {
+        // Pipes, devices and empty files
+        FILE *fp = fdopen(fd, "r");
+        if (fp == NULL) {
+            fprintf(stderr, "[ERROR]: Can not read %s.\n", path);
+            exit(1);
+        }
+        src = source_read(fp, path);
+        fclose(fp);
+    }
+
+    return src;
+}
+
+void source_close(Source *src) {
+    if (src->map_size != 0) {
+        munmap((void *)src->text, src->map_size);
+    } else {
+        free((void *)src->text);
+    }
+    src->text = NULL;
+    src->len = 0;
+    src->map_size = 0;
+}
@@ -0,0 +1,24 @@
+#ifndef WHILE_AI_SOURCE_
+#define WHILE_AI_SOURCE_
+
+#include <stddef.h>
+
+// Source code of the input program, always NUL terminated ('text[len]' is '\0').
+//
+// Regular files are mapped in memory read only, so there is no copy and the pages are loaded lazily.
+// The other inputs (the standard input, pipes) are read in a heap buffer.
+typedef struct {
+    const char *text;
+    size_t len;
+
+    // Size of the mapping starting at 'text', 0 if 'text' is a heap buffer
+    size_t map_size;
+} Source;
+
+// Load the source at 'path' ("-" is the standard input), exits on error
+Source source_open(const char *path);
+
+// Release the memory of the source, the strings pointing in 'text' are no longer valid
+void source_close(Source *src);
+
+#endif // WHILE_AI_SOURCE_
@@ -0,0 +1,115 @@
+#include "../include/abstract_analyzer.h"
+#include "../src/common.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Path of the analyzed programs
+#define ANALYZER_TEST_SRC "test/abstract_analyzer_test.while"
+
+// Straight-line code mixed with loops, conditionals and compound guards
+static const char *analyzer_test_programs[] = {
+    "x := 0; y := 10; while x <= 20 do x := x + 1; y := 10 - x; z := x + y done; w := z * 2",
+
+    "i := 0; s := 0;\n"
+    "while i <= 9 do\n"
+    "    j := 0; t := i;\n"
+    "    while j <= i & 0 <= t do j := j + 1; t := t - 1; s := j + t done;\n"
+    "    if !(s <= 5 & !(i = 5)) then s := 5; u := 1 else skip; u := 2 fi;\n"
+    "    i := i + 1\n"
+    "done;\n"
+    "v := s + u",
+
+    "a := 1; b := 2; c := a + b; if c = 3 then d := c * c; e := d - 1 else d := 0 fi; f := d + e",
+
+    // Unbounded loops, only the finite domains terminate without widening
+    "i := 0; while true do i := i + 1; j := i * 2; k := j - i done",
+};
+
+static void analyzer_test_write(const char *program) {
+    FILE *fp = fopen(ANALYZER_TEST_SRC, "w");
+    if (fp == NULL) {
+        fprintf(stderr, "[ERROR]: Can not write %s.\n", ANALYZER_TEST_SRC);
+        exit(1);
+    }
+    fputs(program, fp);
+    fclose(fp);
+}
+
+// Analyze the program in ANALYZER_TEST_SRC and returns the dump of all the states
+static char *analyzer_test_states(int64_t m, int64_t n, bool basic_blocks, enum While_Analyzer_Strategy strategy) {
+    While_Analyzer_Opt opt = {
+        .type = WHILE_ANALYZER_PARAMETRIC_INTERVAL,
+        .basic_blocks = basic_blocks,
+        .as = {
+            .parametric_interval = {
+                .m = m,
+                .n = n,
+            },
+        },
+    };
+
+    While_Analyzer_Exec_Opt exec_opt = {
+        .widening_delay = SIZE_MAX,
+        .descending_steps = 0,
+        .init_state_path = NULL,
+        .strategy = strategy,
+        .threads = 1,
+    };
+
+    While_Analyzer *wa = while_analyzer_init(ANALYZER_TEST_SRC, &opt);
+    while_analyzer_exec(wa, &exec_opt);
+
+    FILE *fp = tmpfile();
+    assert(fp != NULL);
+    while_analyzer_states_dump(wa, fp);
+    while_analyzer_free(wa);
+
+    long len = ftell(fp);
+    assert(len > 0);
+    rewind(fp);
+    char *dump = xmalloc((size_t)len + 1);
+    size_t read_len = fread(dump, 1, (size_t)len, fp);
+    assert(read_len == (size_t)len);
+    dump[read_len] = '\0';
+    fclose(fp);
+
+    return dump;
+}
+
+// Without widening the basic blocks only change the order of the updates,
+// so the fixpoint is the same of the one computed on all the program points
+void abstract_analyzer_basic_blocks_test(void) {
+    size_t count = sizeof(analyzer_test_programs) / sizeof(analyzer_test_programs[0]);
+
+    for (size_t i = 0; i < count; ++i) {
+        analyzer_test_write(analyzer_test_programs[i]);
+
+        for (int strategy = WHILE_ANALYZER_STRATEGY_WORKLIST; strategy <= WHILE_ANALYZER_STRATEGY_WTO; ++strategy) {
+            // Int(-10,10), and the standard intervals for the programs that terminate
+            char *finite = analyzer_test_states(-10, 10, false, strategy);
+            char *finite_bb = analyzer_test_states(-10, 10, true, strategy);
+            assert(strcmp(finite, finite_bb) == 0);
+            free(finite);
+            free(finite_bb);
+
+            if (i + 1 < count) {
+                char *std = analyzer_test_states(INT64_MIN, INT64_MAX, false, strategy);
+                char *std_bb = analyzer_test_states(INT64_MIN, INT64_MAX, true, strategy);
+                assert(strcmp(std, std_bb) == 0);
+                free(std);
+                free(std_bb);
+            }
+        }
+    }
+
+    remove(ANALYZER_TEST_SRC);
+}
+
+int main(void) {
+    abstract_analyzer_basic_blocks_test();
+    printf("[TEST PASS]: abstract_analyzer_basic_blocks\n");
+    return 0;
+}
@@ -602,6 +602,265 @@ void interval_div_test(void) {
     abstract_interval_ctx_free(ctx);
 }
 
+void interval_widening_test(void) {
+    // m,n integers
+    int64_t m = INTERVAL_MIN_INF;
+    int64_t n = INTERVAL_PLUS_INF;
+    Variables vars = {0};
+    Constants c = {0};
+    constant_push(&c, INTERVAL_MIN_INF);
+    constant_push(&c, 10);
+    constant_push(&c, -5);
+    constant_push(&c, 0);
+    constant_push(&c, 10);
+    constant_push(&c, INTERVAL_PLUS_INF);
+    constants_sort_unique(&c);
+    assert(c.count == 5);
+
+    Abstract_Interval_Ctx *ctx = abstract_interval_ctx_init(m, n, vars, c);
+    Interval i1 = {0};
+    Interval i2 = {0};
+    Interval i_widening = {0};
+
+    // Stable bounds are kept
+    i1 = interval_create(ctx, 0, 2);
+    i2 = interval_create(ctx, 1, 2);
+    i_widening = interval_widening(ctx, i1, i2);
+    assert(i_widening.type == INTERVAL_STD && i_widening.a == 0 && i_widening.b == 2);
+
+    // Unstable upper bound goes to the next threshold
+    i1 = interval_create(ctx, 0, 2);
+    i2 = interval_create(ctx, 0, 3);
+    i_widening = interval_widening(ctx, i1, i2);
+    assert(i_widening.type == INTERVAL_STD && i_widening.a == 0 && i_widening.b == 10);
+
+    // A bound equal to a threshold stays on it
+    i1 = interval_create(ctx, 0, 2);
+    i2 = interval_create(ctx, -5, 10);
+    i_widening = interval_widening(ctx, i1, i2);
+    assert(i_widening.type == INTERVAL_STD && i_widening.a == -5 && i_widening.b == 10);
+
+    // Unstable bounds between the thresholds
+    i1 = interval_create(ctx, 0, 2);
+    i2 = interval_create(ctx, -3, 11);
+    i_widening = interval_widening(ctx, i1, i2);
+    assert(i_widening.type == INTERVAL_STD && i_widening.a == -5 && i_widening.b == INTERVAL_PLUS_INF);
+
+    i1 = interval_create(ctx, 0, 2);
+    i2 = interval_create(ctx, -6, 2);
+    i_widening = interval_widening(ctx, i1, i2);
+    assert(i_widening.type == INTERVAL_STD && i_widening.a == INTERVAL_MIN_INF && i_widening.b == 2);
+
+    // Bottom
+    i1 = interval_create(ctx, 1, -1);
+    i2 = interval_create(ctx, 0, 3);
+    i_widening = interval_widening(ctx, i1, i2);
+    assert(i_widening.type == INTERVAL_STD && i_widening.a == 0 && i_widening.b == 3);
+
+    abstract_interval_ctx_free(ctx);
+}
+
+void abstract_interval_state_equal_test(void) {
+    int64_t m = INTERVAL_MIN_INF;
+    int64_t n = INTERVAL_PLUS_INF;
+    Variables vars = {0};
+    vars_intern(&vars, (String) { .name = "x", .len = 1 });
+    vars_intern(&vars, (String) { .name = "y", .len = 1 });
+    Constants c = {0};
+    Abstract_Interval_Ctx *ctx = abstract_interval_ctx_init(m, n, vars, c);
+
+    Interval *s1 = abstract_interval_state_init(ctx);
+    Interval *s2 = abstract_interval_state_init(ctx);
+
+    // Bottom is canonical, even when produced by the interval operations
+    s1[0] = interval_create(ctx, 3, 2);
+    s1[1] = interval_div(ctx, interval_create(ctx, 1, 5), interval_create(ctx, 0, 0));
+    assert(s1[0].type == INTERVAL_BOTTOM && s1[1].type == INTERVAL_BOTTOM);
+    assert(abstract_interval_state_equal(ctx, s1, s2));
+    assert(abstract_interval_state_hash(ctx, s1) == abstract_interval_state_hash(ctx, s2));
+
+    s1[0] = interval_create(ctx, 0, 10);
+    s2[0] = interval_create(ctx, 0, 10);
+    assert(abstract_interval_state_equal(ctx, s1, s2));
+    assert(abstract_interval_state_hash(ctx, s1) == abstract_interval_state_hash(ctx, s2));
+
+    s2[1] = interval_create(ctx, 0, 10);
+    assert(!abstract_interval_state_equal(ctx, s1, s2));
+    assert(abstract_interval_state_hash(ctx, s1) != abstract_interval_state_hash(ctx, s2));
+
+    // Same intervals on different variables
+    s1[1] = s2[0];
+    s1[0] = s2[1];
+    s1[0].b = 11;
+    assert(!abstract_interval_state_equal(ctx, s1, s2));
+    assert(abstract_interval_state_hash(ctx, s1) != abstract_interval_state_hash(ctx, s2));
+
+    abstract_interval_state_free(s1);
+    abstract_interval_state_free(s2);
+    abstract_interval_ctx_free(ctx);
+    vars_free(&vars);
+}
+
+void abstract_interval_state_exec_guard_test(void) {
+    // m,n integers
+    int64_t m = INTERVAL_MIN_INF;
+    int64_t n = INTERVAL_PLUS_INF;
+    Variables vars = {0};
+    vars_intern(&vars, (String) { .name = "x", .len = 1 });
+    Constants c = {0};
+    Abstract_Interval_Ctx *ctx = abstract_interval_ctx_init(m, n, vars, c);
+
+    // Guard: x + 3 <= x
+    Arena arena = {0};
+    AST_Node *x1 = create_node(&arena, NODE_VAR);
+    x1->as.var.slot = 0;
+    AST_Node *x2 = create_node(&arena, NODE_VAR);
+    x2->as.var.slot = 0;
+    AST_Node *three = create_node(&arena, NODE_NUM);
+    three->as.num = 3;
+    AST_Node *plus = create_node(&arena, NODE_PLUS);
+    plus->as.child.left = x1;
+    plus->as.child.right = three;
+    AST_Node *guard = create_node(&arena, NODE_LEQ);
+    guard->as.child.left = plus;
+    guard->as.child.right = x2;
+
+    Bytecode bc = bytecode_compile(&arena, guard, false);
+    Interval *s = abstract_interval_state_init(ctx);
+    Interval_Exec_Buf *buf = abstract_interval_exec_buf_init(ctx);
+
+    // x = [0,10], the refinements of both the occurrences of x are kept
+    s[0] = interval_create(ctx, 0, 10);
+    abstract_interval_state_exec_command_into(ctx, s, s, &bc, buf);
+    assert(s[0].type == INTERVAL_STD && s[0].a == 3 && s[0].b == 7);
+
+    // x = BOTTOM
+    s[0] = interval_bottom();
+    abstract_interval_state_exec_command_into(ctx, s, s, &bc, buf);
+    assert(s[0].type == INTERVAL_BOTTOM);
+
+    // Guard: (x <= 5 & 2 < x) | x = 9, the states of the operands use the same buffer
+    AST_Node *x3 = create_node(&arena, NODE_VAR);
+    x3->as.var.slot = 0;
+    AST_Node *five = create_node(&arena, NODE_NUM);
+    five->as.num = 5;
+    AST_Node *leq = create_node(&arena, NODE_LEQ);
+    leq->as.child.left = x3;
+    leq->as.child.right = five;
+    AST_Node *x4 = create_node(&arena, NODE_VAR);
+    x4->as.var.slot = 0;
+    AST_Node *two = create_node(&arena, NODE_NUM);
+    two->as.num = 2;
+    AST_Node *gt = create_node(&arena, NODE_GT);
+    gt->as.child.left = x4;
+    gt->as.child.right = two;
+    AST_Node *and = create_node(&arena, NODE_AND);
+    and->as.child.left = leq;
+    and->as.child.right = gt;
+    AST_Node *x5 = create_node(&arena, NODE_VAR);
+    x5->as.var.slot = 0;
+    AST_Node *nine = create_node(&arena, NODE_NUM);
+    nine->as.num = 9;
+    AST_Node *eq = create_node(&arena, NODE_EQ);
+    eq->as.child.left = x5;
+    eq->as.child.right = nine;
+    AST_Node *or = create_node(&arena, NODE_OR);
+    or->as.child.left = and;
+    or->as.child.right = eq;
+
+    Bytecode bc_or = bytecode_compile(&arena, or, false);
+    assert(bc_or.state_depth == 2);
+
+    // x = [0,10]
+    s[0] = interval_create(ctx, 0, 10);
+    abstract_interval_state_exec_command_into(ctx, s, s, &bc_or, buf);
+    assert(s[0].type == INTERVAL_STD && s[0].a == 3 && s[0].b == 9);
+
+    // x = [6,8], only the left operand of the '&' is false
+    s[0] = interval_create(ctx, 6, 8);
+    abstract_interval_state_exec_command_into(ctx, s, s, &bc_or, buf);
+    assert(s[0].type == INTERVAL_BOTTOM);
+
+    abstract_interval_exec_buf_free(buf);
+    abstract_interval_state_free(s);
+    arena_free(&arena);
+    abstract_interval_ctx_free(ctx);
+    vars_free(&vars);
+}
+
+// The backward pass must not prune a guard that holds because of a factor or a quotient equal to 0
+void abstract_interval_state_exec_guard_zero_test(void) {
+    // Int(-10,10)
+    int64_t m = -10;
+    int64_t n = 10;
+    Variables vars = {0};
+    vars_intern(&vars, (String) { .name = "x", .len = 1 });
+    vars_intern(&vars, (String) { .name = "i", .len = 1 });
+    Constants c = {0};
+    Abstract_Interval_Ctx *ctx = abstract_interval_ctx_init(m, n, vars, c);
+
+    // Guard: i * x = i
+    Arena arena = {0};
+    AST_Node *i1 = create_node(&arena, NODE_VAR);
+    i1->as.var.slot = 1;
+    AST_Node *x1 = create_node(&arena, NODE_VAR);
+    x1->as.var.slot = 0;
+    AST_Node *mult = create_node(&arena, NODE_MULT);
+    mult->as.child.left = i1;
+    mult->as.child.right = x1;
+    AST_Node *i2 = create_node(&arena, NODE_VAR);
+    i2->as.var.slot = 1;
+    AST_Node *mult_guard = create_node(&arena, NODE_EQ);
+    mult_guard->as.child.left = mult;
+    mult_guard->as.child.right = i2;
+
+    // Guard: x / i = 0
+    AST_Node *x2 = create_node(&arena, NODE_VAR);
+    x2->as.var.slot = 0;
+    AST_Node *i3 = create_node(&arena, NODE_VAR);
+    i3->as.var.slot = 1;
+    AST_Node *div = create_node(&arena, NODE_DIV);
+    div->as.child.left = x2;
+    div->as.child.right = i3;
+    AST_Node *zero = create_node(&arena, NODE_NUM);
+    zero->as.num = 0;
+    AST_Node *div_guard = create_node(&arena, NODE_EQ);
+    div_guard->as.child.left = div;
+    div_guard->as.child.right = zero;
+
+    Bytecode bc_mult = bytecode_compile(&arena, mult_guard, false);
+    Bytecode bc_div = bytecode_compile(&arena, div_guard, false);
+    Interval *s = abstract_interval_state_init(ctx);
+    Interval_Exec_Buf *buf = abstract_interval_exec_buf_init(ctx);
+
+    // x = [0,0], i = [0,0]: 0 * 0 = 0
+    s[0] = interval_create(ctx, 0, 0);
+    s[1] = interval_create(ctx, 0, 0);
+    abstract_interval_state_exec_command_into(ctx, s, s, &bc_mult, buf);
+    assert(s[0].type == INTERVAL_STD && s[0].a == 0 && s[0].b == 0);
+    assert(s[1].type == INTERVAL_STD && s[1].a == 0 && s[1].b == 0);
+
+    // x = [-3,3], i = [0,0]: every x is kept
+    s[0] = interval_create(ctx, -3, 3);
+    s[1] = interval_create(ctx, 0, 0);
+    abstract_interval_state_exec_command_into(ctx, s, s, &bc_mult, buf);
+    assert(s[0].type == INTERVAL_STD && s[0].a == -3 && s[0].b == 3);
+    assert(s[1].type == INTERVAL_STD && s[1].a == 0 && s[1].b == 0);
+
+    // x = [-2,-2], i = [-3,-3]: -2 / -3 = 0
+    s[0] = interval_create(ctx, -2, -2);
+    s[1] = interval_create(ctx, -3, -3);
+    abstract_interval_state_exec_command_into(ctx, s, s, &bc_div, buf);
+    assert(s[0].type == INTERVAL_STD && s[0].a == -2 && s[0].b == -2);
+    assert(s[1].type == INTERVAL_STD && s[1].a == -3 && s[1].b == -3);
+
+    abstract_interval_exec_buf_free(buf);
+    abstract_interval_state_free(s);
+    arena_free(&arena);
+    abstract_interval_ctx_free(ctx);
+    vars_free(&vars);
+}
+
 int main(void) {
     interval_leq_test();
     printf("[TEST PASS]: interval_leq\n");
@@ -619,5 +878,13 @@ int main(void) {
     printf("[TEST PASS]: interval_mult\n");
     interval_div_test();
     printf("[TEST PASS]: interval_div\n");
+    interval_widening_test();
+    printf("[TEST PASS]: interval_widening\n");
+    abstract_interval_state_equal_test();
+    printf("[TEST PASS]: abstract_interval_state_equal\n");
+    abstract_interval_state_exec_guard_test();
+    printf("[TEST PASS]: abstract_interval_state_exec_guard\n");
+    abstract_interval_state_exec_guard_zero_test();
+    printf("[TEST PASS]: abstract_interval_state_exec_guard_zero\n");
     return 0;
 }
@@ -0,0 +1,95 @@
+// clock_gettime and sysconf are not part of C99
+#define _POSIX_C_SOURCE 200809L
+
+#include "../include/abstract_analyzer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+
+// Path of the generated program
+#define ASYNC_BENCH_SRC "test/async_scaling_bench.while"
+
+// Number of conditionals in the body of the loop, and of iterations of the loop
+#define ASYNC_BENCH_BLOCKS 2000
+#define ASYNC_BENCH_ROUNDS 200
+
+// A single loop with a huge body: all the points are in the same strongly connected component,
+// so the parallel worklist can not help and only the asynchronous strategy runs in parallel.
+static void async_bench_program(void) {
+    FILE *fp = fopen(ASYNC_BENCH_SRC, "w");
+    if (fp == NULL) {
+        fprintf(stderr, "[ERROR]: Can not write %s.\n", ASYNC_BENCH_SRC);
+        exit(1);
+    }
+
+    fprintf(fp, "i := 0;\n");
+    fprintf(fp, "while i <= %d do\n", ASYNC_BENCH_ROUNDS);
+    for (size_t k = 0; k < ASYNC_BENCH_BLOCKS; ++k) {
+        size_t x = k % 64;
+        fprintf(fp, "    if x%zu <= i then x%zu := x%zu + %zu else x%zu := i - %zu fi;\n", x, x, x, k % 7, (x + 1) % 64, k % 5);
+    }
+    fprintf(fp, "    i := i + 1\n");
+    fprintf(fp, "done\n");
+
+    fclose(fp);
+}
+
+static double async_bench_run(enum While_Analyzer_Strategy strategy, size_t threads, size_t *iterations) {
+    While_Analyzer_Opt opt = {
+        .type = WHILE_ANALYZER_PARAMETRIC_INTERVAL,
+        .as = {
+            .parametric_interval = {
+                .m = INT64_MIN,
+                .n = INT64_MAX,
+            },
+        },
+    };
+
+    While_Analyzer_Exec_Opt exec_opt = {
+        .widening_delay = SIZE_MAX,
+        .descending_steps = 0,
+        .init_state_path = NULL,
+        .strategy = strategy,
+        .threads = threads,
+    };
+
+    While_Analyzer *wa = while_analyzer_init(ASYNC_BENCH_SRC, &opt);
+
+    // Wall clock time, the CPU time grows with the threads
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    while_analyzer_exec(wa, &exec_opt);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    *iterations = while_analyzer_iterations(wa);
+    while_analyzer_free(wa);
+
+    return (double)(end.tv_sec - start.tv_sec) + (double)(end.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+int main(void) {
+    async_bench_program();
+
+    // Up to the online processors (at least 2, so the concurrent path always runs)
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t max_threads = cpus > 2 ? (size_t)cpus : 2;
+
+    size_t iterations = 0;
+    double seq = async_bench_run(WHILE_ANALYZER_STRATEGY_WORKLIST, 1, &iterations);
+    printf("[BENCH]: async_scaling, worklist:           %7.3f s, %8zu updates\n", seq, iterations);
+
+    double base = 0;
+    for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+        double t = async_bench_run(WHILE_ANALYZER_STRATEGY_ASYNC, threads, &iterations);
+        if (threads == 1) {
+            base = t;
+        }
+        printf("[BENCH]: async_scaling, async %3zu threads: %7.3f s, %8zu updates, %5.2fx\n", threads, t, iterations, base / t);
+    }
+
+    remove(ASYNC_BENCH_SRC);
+
+    return 0;
+}
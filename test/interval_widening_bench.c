@@ -0,0 +1,57 @@
+#include "../src/domain/abstract_interval_domain.c"
+#include "../src/common.h"
+#include <stdio.h>
+#include <time.h>
+
+#define WIDENING_OPS 1000000
+
+// Simple LCG, so the benchmark is reproducible
+static uint64_t bench_seed = 42;
+static int64_t bench_rand(int64_t bound) {
+    bench_seed = bench_seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (int64_t)((bench_seed >> 33) % (uint64_t)bound);
+}
+
+// Measure the average cost of a widening where both bounds are unstable,
+// with 'thresholds' widening points spread over [-thresholds, thresholds]
+static double widening_bench(size_t thresholds) {
+    Variables vars = {0};
+    Constants c = {0};
+    constant_push(&c, INTERVAL_MIN_INF);
+    constant_push(&c, INTERVAL_PLUS_INF);
+    for (size_t i = 0; i < thresholds; ++i) {
+        constant_push(&c, 2*(int64_t)i - (int64_t)thresholds);
+    }
+    constants_sort_unique(&c);
+
+    Abstract_Interval_Ctx *ctx = abstract_interval_ctx_init(INTERVAL_MIN_INF, INTERVAL_PLUS_INF, vars, c);
+
+    // Keep the result alive, so the compiler can not drop the loop
+    volatile int64_t sink = 0;
+    const int64_t range = (int64_t)thresholds + 1;
+
+    clock_t start = clock();
+    for (size_t i = 0; i < WIDENING_OPS; ++i) {
+        int64_t a = bench_rand(range);
+        int64_t b = bench_rand(range);
+        Interval i1 = interval_create(ctx, -a, b);
+        Interval i2 = interval_create(ctx, -a - 1, b + 1);
+        Interval w = interval_widening(ctx, i1, i2);
+        sink += w.a ^ w.b;
+    }
+    clock_t end = clock();
+
+    abstract_interval_ctx_free(ctx);
+
+    return (double)(end - start) / CLOCKS_PER_SEC * 1e9 / WIDENING_OPS;
+}
+
+int main(void) {
+    const size_t thresholds[] = { 10, 100, 1000, 10000, 100000 };
+
+    for (size_t i = 0; i < sizeof(thresholds)/sizeof(thresholds[0]); ++i) {
+        printf("[BENCH]: interval_widening, %6zu thresholds: %6.1f ns/op\n", thresholds[i], widening_bench(thresholds[i]));
+    }
+
+    return 0;
+}
@@ -0,0 +1,46 @@
+#include "../src/lang/lexer.h"
+#include "../src/common.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Size of the generated source
+#define LEXER_BENCH_SIZE (32 * 1024 * 1024)
+
+// Statements repeated for building the source, with a mix of keywords, variables, numbers and symbols
+static const char *lexer_bench_snippet[] = {
+    "counter := counter + 1;\n",
+    "if (x <= 100) & !(y = z) then x := x * 2 - y / 3 else skip fi;\n",
+    "while whileCounter <= 4096 do whileCounter := whileCounter + step; done1 := true1 done;\n",
+    "result := (alpha + beta) * (gamma - 42) / delta;\n",
+};
+
+int main(void) {
+    const size_t snippets = sizeof(lexer_bench_snippet) / sizeof(lexer_bench_snippet[0]);
+
+    // Generate the source
+    char *src = xmalloc(LEXER_BENCH_SIZE + 256);
+    size_t len = 0;
+    for (size_t i = 0; len < LEXER_BENCH_SIZE; i = (i + 1) % snippets) {
+        size_t snippet_len = strlen(lexer_bench_snippet[i]);
+        memcpy(src + len, lexer_bench_snippet[i], snippet_len);
+        len += snippet_len;
+    }
+    src[len] = '\0';
+
+    clock_t start = clock();
+    Lexer *lex = lex_init(src);
+    clock_t end = clock();
+
+    size_t count = 0;
+    lex_tokens(lex, &count);
+
+    double seconds = (double)(end - start) / CLOCKS_PER_SEC;
+    printf("[BENCH]: lexer, %.1f MB, %zu tokens: %.1f MB/s\n", len / 1e6, count, len / 1e6 / seconds);
+
+    lex_free(lex);
+    free(src);
+
+    return 0;
+}
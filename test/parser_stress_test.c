@@ -0,0 +1,153 @@
+#include "../src/lang/lexer.h"
+#include "../src/lang/parser.h"
+#include "../src/lang/cfg.h"
+#include "../src/lang/wto.h"
+#include "../src/common.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Number of statements of the long programs
+#define STRESS_STMTS 1000000
+
+// Nesting depth of the nested programs
+#define STRESS_DEPTH 100000
+
+// Growing source buffer
+typedef struct {
+    char *data;
+    size_t len;
+    size_t capacity;
+} Source;
+
+static void source_append(Source *src, const char *s) {
+    size_t len = strlen(s);
+    if (src->len + len + 1 > src->capacity) {
+        src->capacity = src->capacity == 0 ? 4096 : src->capacity;
+        while (src->len + len + 1 > src->capacity) {
+            src->capacity *= 2;
+        }
+        src->data = xrealloc(src->data, src->capacity);
+    }
+    memcpy(src->data + src->len, s, len + 1);
+    src->len += len;
+}
+
+// Parse the program and build its CFG (and its WTO if 'with_wto'), returns the number of CFG nodes
+static size_t stress_cfg_count(const char *src, bool with_wto) {
+    Arena arena = {0};
+    Variables vars = {0};
+    vars_intern(&vars, (String) { .name = "x", .len = 1 });
+
+    Lexer *lex = lex_init(src);
+    AST_Node *root = parser_parse(lex, &arena);
+    CFG *cfg = cfg_get(root, &vars, &arena);
+
+    // All the nodes are reachable from P0, so they are all in the WTO
+    if (with_wto) {
+        WTO *wto = wto_get(cfg);
+        assert(wto->count == cfg->count);
+        wto_free(wto);
+    }
+
+    size_t count = cfg->count;
+    lex_free(lex);
+    vars_free(&vars);
+    arena_free(&arena);
+    return count;
+}
+
+void parser_stress_seq_test(void) {
+    Source src = {0};
+    for (size_t i = 0; i < STRESS_STMTS - 1; ++i) {
+        source_append(&src, "x := x + 1;\n");
+    }
+    source_append(&src, "skip");
+
+    // One node for each statement plus the final one
+    assert(stress_cfg_count(src.data, true) == STRESS_STMTS + 1);
+    free(src.data);
+}
+
+void parser_stress_while_test(void) {
+    Source src = {0};
+    for (size_t i = 0; i < STRESS_DEPTH; ++i) {
+        source_append(&src, "while x <= 10 do ");
+    }
+    source_append(&src, "x := x + 1");
+    for (size_t i = 0; i < STRESS_DEPTH; ++i) {
+        source_append(&src, " done");
+    }
+
+    // Every while adds 2 skip nodes and the loop invariant node.
+    // No WTO here, it is quadratic in the loops depth (every component visits again its body)
+    assert(stress_cfg_count(src.data, false) == 3*STRESS_DEPTH + 2);
+    free(src.data);
+}
+
+void parser_stress_if_test(void) {
+    Source src = {0};
+    for (size_t i = 0; i < STRESS_DEPTH; ++i) {
+        source_append(&src, "if !(x = 1) & x <= 10 then skip; ");
+    }
+    source_append(&src, "skip");
+    for (size_t i = 0; i < STRESS_DEPTH; ++i) {
+        source_append(&src, " else x := 0 fi");
+    }
+
+    // Every if adds 2 skip nodes, the if node and the two statements of its branches
+    assert(stress_cfg_count(src.data, true) == 5*STRESS_DEPTH + 2);
+    free(src.data);
+}
+
+void parser_stress_expr_test(void) {
+    // Left deep sum
+    Source src = {0};
+    source_append(&src, "x := x");
+    for (size_t i = 0; i < STRESS_STMTS; ++i) {
+        source_append(&src, " + 1");
+    }
+    assert(stress_cfg_count(src.data, true) == 2);
+    free(src.data);
+
+    // Right deep sum
+    src = (Source) {0};
+    source_append(&src, "x := ");
+    for (size_t i = 0; i < STRESS_DEPTH; ++i) {
+        source_append(&src, "(1 + ");
+    }
+    source_append(&src, "x");
+    for (size_t i = 0; i < STRESS_DEPTH; ++i) {
+        source_append(&src, ")");
+    }
+    assert(stress_cfg_count(src.data, true) == 2);
+    free(src.data);
+
+    // Nested negations
+    src = (Source) {0};
+    source_append(&src, "if ");
+    for (size_t i = 0; i < STRESS_DEPTH; ++i) {
+        source_append(&src, "!(x <= 1 & ");
+    }
+    source_append(&src, "true");
+    for (size_t i = 0; i < STRESS_DEPTH; ++i) {
+        source_append(&src, ")");
+    }
+    source_append(&src, " then skip else skip fi");
+    assert(stress_cfg_count(src.data, true) == 6);
+    free(src.data);
+}
+
+int main(void) {
+    parser_stress_seq_test();
+    printf("[TEST PASS]: parser_stress_seq\n");
+    parser_stress_while_test();
+    printf("[TEST PASS]: parser_stress_while\n");
+    parser_stress_if_test();
+    printf("[TEST PASS]: parser_stress_if\n");
+    parser_stress_expr_test();
+    printf("[TEST PASS]: parser_stress_expr\n");
+    return 0;
+}